@@ -0,0 +1,90 @@
+/*
+    FILE: asset_archive.h
+    Defines the asset archive format (a single file packing every asset of the game, written by the
+    asset_pack tool in src/tools) and the AssetArchive class, which reads archives by memory-mapping them.
+*/
+#pragma once
+#include<cstddef>
+#include<cstdint>
+#include<string_view>
+
+/*
+    Layout of an archive file (numbers, like decoded pixels and samples, are in the machine's byte order,
+    since the structs below are read and written as is):
+      ArchiveHeader
+      ArchiveEntry[entryCount], sorted by path hash (ties by path)
+      paths, back to back, not null terminated
+      payloads, each one starting at a multiple of ARCHIVE_ALIGNMENT
+    Payloads are either the original file's bytes, or the file already decoded (see ArchiveEntryType),
+    so that it can be used straight from the mapped file without decoding it.
+*/
+// Archives are native-endian, so they only carry over between machines with the same byte order. Every
+// platform the game runs on is little-endian (MSVC doesn't define __BYTE_ORDER__, but only targets those).
+#if defined(__BYTE_ORDER__)
+static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__, "asset archives are only supported on little-endian machines");
+#endif
+
+inline constexpr char ARCHIVE_MAGIC[8] = {'U', 'S', 'M', 'G', 'P', 'A', 'K', '\0'};
+inline constexpr uint32_t ARCHIVE_VERSION = 1;
+inline constexpr size_t ARCHIVE_ALIGNMENT = 64;
+
+enum class ArchiveEntryType : uint32_t {
+    FILE = 0,     // The original file's bytes
+    IMAGE_RGBA8,  // Decoded image, 8 bits per channel RGBA pixels. info: width, height
+    WAVE_PCM,     // Decoded sound, interleaved samples. info: frameCount, sampleRate, sampleSize (bits), channels
+};
+
+struct ArchiveHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t entryCount;
+    uint64_t entriesOffset;
+    uint64_t pathsOffset;
+};
+
+struct ArchiveEntry {
+    uint64_t pathHash; // util::hash_string of the path
+    uint64_t dataOffset;
+    uint64_t dataSize;
+    uint32_t pathOffset; // From the header's pathsOffset
+    uint32_t pathSize;
+    ArchiveEntryType type;
+    uint32_t info[4]; // Description of the payload, depending on the type
+};
+
+/*
+    Read-only view of an archive file, which is memory-mapped (or read whole, on platforms without mmap)
+    when it's opened. Lookups binary search the entries by path hash, so they don't touch the file system.
+    Pointers returned by data() stay valid until the archive is closed.
+*/
+class AssetArchive {
+  private:
+    const unsigned char* m_bytes = nullptr;
+    size_t m_size = 0;
+    const ArchiveEntry* m_entries = nullptr;
+    uint32_t m_entryCount = 0;
+    const char* m_paths = nullptr;
+  public:
+    AssetArchive() = default;
+    ~AssetArchive();
+    AssetArchive(const AssetArchive&) = delete;
+    AssetArchive& operator=(const AssetArchive&) = delete;
+
+    // Opens the given archive file, closing the current one if there is one. Returns false (leaving the
+    // archive closed) if the file can't be opened or isn't a valid archive.
+    bool open(const char* filepath);
+    void close();
+    inline bool is_open() const { return m_bytes != nullptr; }
+
+    // Returns the entry with the given path, or null if there isn't one.
+    const ArchiveEntry* find(std::string_view path) const;
+    // Returns the payload of the given entry.
+    inline const unsigned char* data(const ArchiveEntry& entry) const {
+        return m_bytes + entry.dataOffset;
+    }
+    // Returns the path of the given entry.
+    inline std::string_view path(const ArchiveEntry& entry) const {
+        return std::string_view(m_paths + entry.pathOffset, entry.pathSize);
+    }
+    inline size_t size() const { return m_entryCount; }
+};
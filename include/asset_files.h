@@ -0,0 +1,45 @@
+/*
+    FILE: asset_files.h
+    Defines the AssetFiles module, through which every asset file is read: from the mounted asset
+    archive if there is one and it has the file, or from the file system otherwise.
+*/
+#pragma once
+#include"raylib.h"
+#include"asset_archive.h"
+#include<string>
+
+namespace AssetFiles {
+
+// The mounted archive. Closed unless mount_archive succeeded.
+inline AssetArchive _archive;
+
+// Mounts the given archive, so that files are looked up in it before the file system. Returns false
+// if it couldn't be opened. Must be called before any asset is loaded (and not while any is).
+bool mount_archive(const char* filepath);
+// Unmounts the archive. Every image and wave pointing into it must have been unloaded.
+void unmount_archive();
+
+// Image loaded through AssetFiles. Images stored decoded in the archive point straight into the
+// mapped archive instead of being copied, so they must be unloaded with unload_image.
+struct AssetImage {
+    Image image = {};
+    bool ownsData = false;
+};
+// Same as AssetImage, for sounds.
+struct AssetWave {
+    Wave wave = {};
+    bool ownsData = false;
+};
+
+// Loads the given image file (see LoadImage). The image is invalid if it couldn't be loaded.
+AssetImage load_image(const char* filepath);
+void unload_image(AssetImage& image);
+
+// Loads the given sound file (see LoadWave). The wave is invalid if it couldn't be loaded.
+AssetWave load_wave(const char* filepath);
+void unload_wave(AssetWave& wave);
+
+// Reads the whole given file into `out`. Returns false if it couldn't be read.
+bool load_file(const char* filepath, std::string& out);
+
+} // namespace AssetFiles
@@ -0,0 +1,85 @@
+/*
+    FILE: asset_prefetcher.h
+    Defines the AssetPrefetcher class, which loads the assets a level is going to need ahead of time,
+    decoding them in parallel on the job system's workers.
+*/
+#pragma once
+#include"raylib.h"
+#include"asset_files.h"
+#include"asset_registry.h"
+#include"job_system.h"
+#include<deque>
+#include<string>
+#include<unordered_set>
+#include<vector>
+
+/*
+    Loads a batch of textures and sounds in parallel. Files are decoded (see AssetFiles) on worker
+    threads as soon as they're requested, and upload() then packs the small images into texture atlas
+    pages (see TextureAtlas) and sends the pages and the remaining textures to the GPU in a single
+    main-thread job. Uploaded assets are registered in the SpriteLoader and SoundLoader, with one reference
+    held by the prefetcher until release() (or destruction), so that loading them through the loaders in
+    the meantime just finds them already loaded. Intended usage, while building a level:
+      AssetPrefetcher prefetcher;
+      prefetcher.prefetch_texture(...); // for every asset the level uses
+      prefetcher.upload();
+      // build the level, loading assets through the loaders as usual
+      prefetcher.release(); // assets nothing ended up using are unloaded
+    Not thread safe: a prefetcher is meant to be used by one thread at a time.
+*/
+class AssetPrefetcher {
+  private:
+    struct PendingTexture {
+        std::string filepath;
+        AssetFiles::AssetImage image;
+        JobSystem::TaskHandle decode;
+    };
+    struct PendingSound {
+        std::string filepath;
+        Sound sound = {};
+        JobSystem::TaskHandle decode;
+    };
+    // Deques, so that the decode tasks can keep writing to their entry while more get added
+    std::deque<PendingTexture> pendingTextures;
+    std::deque<PendingSound> pendingSounds;
+    // Every file requested so far, so that each one is only loaded once
+    std::unordered_set<std::string> requestedFiles;
+    // Image files requested with prefetch_texture, which get a texture of their own even if they were
+    // also requested with prefetch_texture_region
+    std::unordered_set<std::string> unpackableFiles;
+    // Assets uploaded and registered by this prefetcher (atlas pages included), each with one reference held by it
+    std::vector<Texture> textures;
+    std::vector<SoundId> sounds;
+    // Starts decoding the given image file, unless it's already requested or loaded (see prefetch_texture).
+    JobSystem::TaskHandle request_texture(const std::string& filepath);
+  public:
+    AssetPrefetcher() = default;
+    // Calls release().
+    ~AssetPrefetcher();
+    AssetPrefetcher(const AssetPrefetcher&) = delete;
+    AssetPrefetcher& operator=(const AssetPrefetcher&) = delete;
+
+    // Starts decoding the given image file on a worker and returns the task doing it. Returns a null
+    // handle if the file has already been requested or is already loaded by the SpriteLoader. The file
+    // gets a texture of its own, to be loaded with SpriteLoader::load_or_get_texture.
+    JobSystem::TaskHandle prefetch_texture(const std::string& filepath);
+    // Same as prefetch_texture, but the image may be packed into an atlas page, so it must be loaded with
+    // SpriteLoader::load_or_get_texture_region (which is what SpriteSheet and TilesetTile do).
+    JobSystem::TaskHandle prefetch_texture_region(const std::string& filepath);
+    // Starts loading the given sound file on a worker, just like prefetch_texture. Sounds don't need the
+    // main thread at all, since raylib's audio module has its own locking.
+    JobSystem::TaskHandle prefetch_sound(const std::string& filepath);
+
+    /*
+        Waits for every requested file to be decoded (running other jobs in the meantime), packs the images
+        requested with prefetch_texture_region into atlas pages, uploads the pages and the other textures at
+        once on the main thread (see JobSystem::run_on_main_thread_and_wait) and registers every asset in its
+        loader, along with the atlas region of every packed image (see SpriteLoader::register_atlas_region).
+        Files that couldn't be decoded are skipped, so loading them through the loaders later fails (or
+        succeeds) just like without prefetching. Can be called from any thread.
+    */
+    void upload();
+    // Gives back the prefetcher's reference to every asset it registered, unloading the ones nothing else
+    // uses. Any pending decodes are waited for and discarded.
+    void release();
+};
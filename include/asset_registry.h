@@ -0,0 +1,251 @@
+/*
+    FILE: asset_registry.h
+    Defines the AssetRegistry class, which keeps track of the loaded assets of one type (textures,
+    sounds) and how many users each one has, and the handles used to refer to them.
+*/
+#pragma once
+#include"raylib.h"
+#include<cstddef>
+#include<cstdint>
+#include<mutex>
+#include<optional>
+#include<stdexcept>
+#include<string>
+#include<unordered_map>
+#include<utility>
+#include<vector>
+
+/*
+    Handle to an asset of type T in an AssetRegistry: the index of its slot in the registry and the
+    generation of that slot, packed in 32 bits. Slots are reused once their asset is unloaded, but with
+    the next generation, so handles to an unloaded asset are detected instead of referring to whatever
+    asset took its slot. The handle with value 0 is never valid.
+*/
+template<class T>
+struct AssetHandle {
+    static constexpr uint32_t GENERATION_BITS = 12;
+    static constexpr uint32_t GENERATION_MASK = (1u << GENERATION_BITS) - 1;
+    static constexpr uint32_t MAX_SLOTS = 1u << (32 - GENERATION_BITS);
+
+    uint32_t value = 0;
+
+    static inline AssetHandle make(uint32_t index, uint32_t generation){
+        return AssetHandle{(index << GENERATION_BITS) | generation};
+    }
+    inline uint32_t index() const { return value >> GENERATION_BITS; }
+    inline uint32_t generation() const { return value & GENERATION_MASK; }
+    inline bool is_valid() const { return value != 0; }
+    inline bool operator==(const AssetHandle& other) const { return value == other.value; }
+    inline bool operator!=(const AssetHandle& other) const { return value != other.value; }
+};
+
+using TextureId = AssetHandle<Texture>;
+using SoundId = AssetHandle<Sound>;
+
+/*
+    What an AssetRegistry needs to know about each type of asset:
+      key(asset): a number that identifies the loaded asset (e.g. its GPU id), to find its handle from
+                  the asset itself (see AssetRegistry::find_by_asset)
+      bytes(asset): how much memory the asset takes, for AssetRegistry::stats
+*/
+template<class T>
+struct AssetTraits;
+
+template<>
+struct AssetTraits<Texture> {
+    static inline uintptr_t key(const Texture& texture){ return texture.id; }
+    static inline size_t bytes(const Texture& texture){
+        return GetPixelDataSize(texture.width, texture.height, texture.format);
+    }
+};
+
+template<>
+struct AssetTraits<Sound> {
+    static inline uintptr_t key(const Sound& sound){ return (uintptr_t)sound.stream.buffer; }
+    static inline size_t bytes(const Sound& sound){
+        return (size_t)sound.frameCount * sound.stream.channels * (sound.stream.sampleSize / 8);
+    }
+};
+
+// Number of assets loaded in a registry, and the memory they take.
+struct AssetStats {
+    size_t liveAssets = 0;
+    size_t bytes = 0;
+};
+
+/*
+    Registry of loaded assets of type T, each one registered under a unique name (usually the file it
+    was loaded from) with a reference count. Assets are stored in slots which are reused once freed,
+    and indexed both by name and by key (see AssetTraits), so that every operation is a hash lookup at
+    most, no matter how many assets are loaded.
+    The registry doesn't load or unload anything itself: release() hands back the asset once it has no
+    users left, for the caller to unload. Thread safe, every operation locks the registry's mutex.
+*/
+template<class T>
+class AssetRegistry {
+  public:
+    using Handle = AssetHandle<T>;
+  private:
+    using Traits = AssetTraits<T>;
+    struct Slot {
+        T asset;
+        std::string name;
+        size_t bytes = 0;
+        uint32_t refCount = 0; // zero if the slot is free
+        uint32_t generation = 0;
+    };
+    std::vector<Slot> slots;
+    std::vector<uint32_t> freeSlots;
+    std::unordered_map<std::string, uint32_t> nameIndex;
+    std::unordered_map<uintptr_t, uint32_t> keyIndex;
+    AssetStats totals;
+    mutable std::mutex mutex;
+
+    // Returns the slot the given handle refers to, or null if its asset has been unloaded since.
+    inline Slot* lookup(Handle handle){
+        if(!handle.is_valid() || handle.index() >= slots.size()){
+            return nullptr;
+        }
+        Slot& slot = slots[handle.index()];
+        return (slot.refCount > 0 && slot.generation == handle.generation()) ? &slot : nullptr;
+    }
+    inline const Slot* lookup(Handle handle) const {
+        return const_cast<AssetRegistry*>(this)->lookup(handle);
+    }
+    inline Handle handle_of(uint32_t index) const {
+        return Handle::make(index, slots[index].generation);
+    }
+    Handle insert_locked(std::string&& name, const T& asset, uint32_t refCount){
+        uint32_t index;
+        if(!freeSlots.empty()){
+            index = freeSlots.back();
+            freeSlots.pop_back();
+        } else {
+            if(slots.size() >= Handle::MAX_SLOTS){
+                throw std::length_error("Too many assets loaded at once");
+            }
+            index = slots.size();
+            slots.emplace_back();
+        }
+        Slot& slot = slots[index];
+        // generation 0 is skipped, so that no handle is ever 0
+        slot.generation = (slot.generation + 1) & Handle::GENERATION_MASK;
+        if(slot.generation == 0){
+            slot.generation = 1;
+        }
+        slot.asset = asset;
+        slot.bytes = Traits::bytes(asset);
+        slot.refCount = refCount;
+        nameIndex.emplace(name, index);
+        keyIndex[Traits::key(asset)] = index;
+        slot.name = std::move(name);
+        totals.liveAssets++;
+        totals.bytes += slot.bytes;
+        return handle_of(index);
+    }
+  public:
+    /*
+        Registers the given asset under the given name with the given reference count (which must be at
+        least 1) and returns its handle. If there's already an asset with that name, acquires it instead,
+        and returns its handle and false, so that the caller can unload the duplicate.
+    */
+    std::pair<Handle, bool> insert(std::string name, const T& asset, uint32_t refCount = 1){
+        std::lock_guard<std::mutex> lock(mutex);
+        auto iter = nameIndex.find(name);
+        if(iter != nameIndex.end()){
+            slots[iter->second].refCount++;
+            return {handle_of(iter->second), false};
+        }
+        return {insert_locked(std::move(name), asset, refCount), true};
+    }
+    // Same as insert, but if the name is already taken, underscores are appended to it until it isn't.
+    Handle insert_unique(std::string name, const T& asset, uint32_t refCount = 1){
+        std::lock_guard<std::mutex> lock(mutex);
+        while(nameIndex.find(name) != nameIndex.end()){
+            name += '_';
+        }
+        return insert_locked(std::move(name), asset, refCount);
+    }
+
+    // If an asset with the given name is registered, increases its reference count and returns its handle.
+    // Returns an invalid handle otherwise.
+    Handle acquire(const std::string& name){
+        std::lock_guard<std::mutex> lock(mutex);
+        auto iter = nameIndex.find(name);
+        if(iter == nameIndex.end()){
+            return Handle{};
+        }
+        slots[iter->second].refCount++;
+        return handle_of(iter->second);
+    }
+    // Increases the reference count of the given asset. Throws std::invalid_argument if it isn't loaded.
+    T acquire(Handle handle){
+        std::lock_guard<std::mutex> lock(mutex);
+        Slot* slot = lookup(handle);
+        if(slot == nullptr){
+            throw std::invalid_argument("Acquiring an asset that isn't loaded");
+        }
+        slot->refCount++;
+        return slot->asset;
+    }
+    // Decreases the reference count of the given asset. Once it reaches zero, the asset is unregistered
+    // and returned, for the caller to unload it. Does nothing if the asset isn't loaded.
+    std::optional<T> release(Handle handle){
+        std::lock_guard<std::mutex> lock(mutex);
+        Slot* slot = lookup(handle);
+        if(slot == nullptr || --slot->refCount > 0){
+            return std::nullopt;
+        }
+        nameIndex.erase(slot->name);
+        // assets that failed to load can share a key, in which case it's kept for whichever was registered last
+        auto keyIter = keyIndex.find(Traits::key(slot->asset));
+        if(keyIter != keyIndex.end() && keyIter->second == handle.index()){
+            keyIndex.erase(keyIter);
+        }
+        slot->name.clear();
+        totals.liveAssets--;
+        totals.bytes -= slot->bytes;
+        freeSlots.push_back(handle.index());
+        return slot->asset;
+    }
+
+    // Returns the handle of the given loaded asset (found by its key, see AssetTraits), or an invalid
+    // handle if it isn't registered.
+    Handle find_by_asset(const T& asset) const {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto iter = keyIndex.find(Traits::key(asset));
+        return (iter != keyIndex.end()) ? handle_of(iter->second) : Handle{};
+    }
+    // Returns the given asset. Throws std::invalid_argument if it isn't loaded.
+    T get(Handle handle) const {
+        std::lock_guard<std::mutex> lock(mutex);
+        const Slot* slot = lookup(handle);
+        if(slot == nullptr){
+            throw std::invalid_argument("Getting an asset that isn't loaded");
+        }
+        return slot->asset;
+    }
+    // Returns the given asset, or nothing if it isn't loaded.
+    std::optional<T> try_get(Handle handle) const {
+        std::lock_guard<std::mutex> lock(mutex);
+        const Slot* slot = lookup(handle);
+        return (slot != nullptr) ? std::optional<T>(slot->asset) : std::nullopt;
+    }
+    // Returns the name the given asset was registered with, or an empty string if it isn't loaded.
+    std::string get_name(Handle handle) const {
+        std::lock_guard<std::mutex> lock(mutex);
+        const Slot* slot = lookup(handle);
+        return (slot != nullptr) ? slot->name : std::string();
+    }
+    // Returns the reference count of the asset with the given name, or 0 if there isn't one.
+    size_t get_ref_count(const std::string& name) const {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto iter = nameIndex.find(name);
+        return (iter != nameIndex.end()) ? slots[iter->second].refCount : 0;
+    }
+    // Returns the number of assets loaded and the memory they take.
+    AssetStats stats() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return totals;
+    }
+};
@@ -8,6 +8,7 @@
 #include"raylib.h"
 #include"utility.h"
 #include"sprite_loader.h"
+#include"name_table.h"
 #include<vector>
 
 enum CoordinateType {
@@ -70,8 +71,11 @@ inline Vector2 to_Vector2(const Acceleration& accel){
 */
 struct SpriteSheet{
     Texture2D texture; // Raylib texture to use
-    unsigned short numberFramesPerRow; // Maximum number of frames per animation. Equivalent to texture.width/[frame width]
-    unsigned short numberRows; // Total number of animations. Equivalent to texture.height/[frame height]
+    // Area of the texture that holds the spritesheet: the whole texture, unless it's been packed
+    // into a texture atlas page (see SpriteLoader::load_or_get_texture_region)
+    Rectangle source;
+    unsigned short numberFramesPerRow; // Maximum number of frames per animation. Equivalent to source.width/[frame width]
+    unsigned short numberRows; // Total number of animations. Equivalent to source.height/[frame height]
     /*
         Array that stores the number of frames for each individual animation.
         For animation i, numberFramesPerAnimation[i] returns its own number of
@@ -83,6 +87,8 @@ struct SpriteSheet{
     unsigned short currentFrame;
 
     SpriteSheet(const char* filename, unsigned int frameWidth, unsigned int frameHeight);
+    // Uses the given texture region, taking over the reference to its texture.
+    SpriteSheet(const SpriteLoader::TextureRegion& region, unsigned int frameWidth, unsigned int frameHeight);
     ~SpriteSheet();
     // equivalent to calling mySpriteSheet.numberFramesPerAnimation[animationRow] = length;
     void set_animation_length(unsigned int animationRow, unsigned short length);
@@ -104,10 +110,11 @@ struct SpriteTransform{
 };
 
 /*
-    Defines a 'name' for the entity. Not used yet, might be deleted.
+    Defines a 'name' for the entity, as a handle into the level's name table (see NameTable).
+    Use LevelRegistry::get_entity_name to get the actual name.
 */
 struct EntityName{
-    std::string name;
+    NameHandle handle;
 };
 
 // Moves a position according to a constant velocity with the specified delta-time
@@ -115,6 +122,9 @@ void move_position(Position& pos, const Velocity& vel, float delta);
 // Moves a position according to a velocity which itself gets moved according to
 // a constant acceleration, both with the specified delta-time
 void move_position(Position& pos, Velocity& vel, const Acceleration& acc, float delta);
+// Batched version of the first move_position, which moves `count` contiguous positions
+// according to their respective contiguous velocities. Vectorized (see util::add_scaled).
+void move_positions(Position* positions, const Velocity* velocities, size_t count, float delta);
 // Switches the given SpriteSheet to the next frame, looping back to the start when the
 // animation's end is reached.
 void next_frame(SpriteSheet& sprite);
@@ -124,6 +134,10 @@ void prev_frame(SpriteSheet& sprite);
 // [Auxiliary] Outputs the Rectangle resulting from applying the given SpriteTransform
 // to the given rectangle which would correspond to the drawing rectangle of a SpriteSheet frame.
 Rectangle transform_frame_rect(const Rectangle& source, const SpriteTransform& transform);
+// [Auxiliary] Outputs the arguments DrawTexturePro needs to draw the sprite's current frame (the area of
+// the texture, the destination rectangle and the rotation origin) with the given transform.
+void get_sprite_draw_rects(const SpriteSheet& sprite, const SpriteTransform& transform, const Position& pos,
+                           Rectangle& source, Rectangle& dest, Vector2& origin);
 
 // Draws a sprite to the screen, with or without a SpriteTransform.
 // Made to be used within Raylib's BeginDrawing() ... EndDrawing() functions.
@@ -10,6 +10,7 @@
 #include"utility.h"
 #include"basic_components.h"
 #include"collision_component.h"
+#include"entt.hpp"
 
 /*
 Basic bounding box component. All entities with a drawable component or a 
@@ -54,4 +55,56 @@ BoundingBoxComponent calculate_bb(const CollisionComponent& collision, float mar
 
 // Calculates a minimal bounding box that totally covers the given sprite with a margin
 // to spare
-BoundingBoxComponent calculate_bb(const SpriteSheet& sprite, float margin = 0);
\ No newline at end of file
+BoundingBoxComponent calculate_bb(const SpriteSheet& sprite, float margin = 0);
+
+/*
+    World-space bounding box of an entity, i.e. its BoundingBoxComponent moved to its position. Kept
+    up to date automatically (see track_world_aabbs) for every entity with both a position and a bounding
+    box, and stored in its own contiguous storage, so that the collision broadphase and the culling pass
+    only have to read one packed array and don't redo the addition on every check.
+*/
+struct WorldAABB{
+    Vector2 min;
+    Vector2 max;
+};
+
+// Returns the world-space box covered by the given bounding box at the given position.
+inline WorldAABB to_world_aabb(const BoundingBoxComponent& bb, const Position& pos){
+    Vector2 min = bb.offset + to_Vector2(pos);
+    return WorldAABB{min, min + Vector2{bb.width, bb.height}};
+}
+
+// Basic world-space box intersection check. Same result as overlapping_bb on the original bounding boxes.
+inline bool overlapping_aabb(const WorldAABB& aabb1, const WorldAABB& aabb2){
+    return (
+        aabb1.max.x >= aabb2.min.x &&
+        aabb1.min.x <= aabb2.max.x &&
+        aabb1.max.y >= aabb2.min.y &&
+        aabb1.min.y <= aabb2.max.y
+    );
+}
+
+// Recalculates the entity's bounding box from its collision component or, if it doesn't have one,
+// its sprite, adding the bounding box if it doesn't exist.
+void recalculate_bounding_box(entt::registry& registry, entt::entity entity);
+
+// Recalculates the entity's WorldAABB from its position and bounding box. Removes it if the entity
+// doesn't have both.
+void refresh_world_aabb(entt::registry& registry, entt::entity entity);
+
+/*
+    Connects to the registry's signals so that WorldAABBs get refreshed whenever a Position or
+    BoundingBoxComponent is added or replaced/patched, and bounding boxes get recalculated whenever a
+    CollisionComponent or SpriteSheet is replaced/patched. Positions written to directly (like the
+    ones moved every frame) don't trigger any signal, so their owners must refresh them themselves
+    (see refresh_moving_world_aabbs). Everything else, like static geometry, is never recomputed.
+*/
+void track_world_aabbs(entt::registry& registry);
+
+// Refreshes the WorldAABBs of the entities moved by their velocity this frame, i.e. the ones whose
+// velocity isn't zero. Anything else that moves an entity must go through the registry's signals or
+// refresh its box itself.
+void refresh_moving_world_aabbs(entt::registry& registry);
+
+// Refreshes every WorldAABB in the registry (e.g. after restoring a snapshot).
+void refresh_all_world_aabbs(entt::registry& registry);
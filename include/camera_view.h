@@ -37,8 +37,12 @@ void set_camera_center(CameraView& camera, const Position& pos);
     #define CAMERA_ZOOM_OUT true
 // Zooms the camera in or out by the given factor, which can be CAMERA_ZOOM_IN or CAMERA_ZOOM_OUT.
 void zoom_camera(CameraView& camera, float zoomFactor, bool zoomMode = CAMERA_ZOOM_IN);
-// Returns a bounding box that covers everything the camera sees. WARNING: Assumes the camera is NOT rotated!
+// Returns a bounding box that covers everything the camera sees. If the camera is rotated, this is the
+// smallest axis-aligned box that encloses the (rotated) view.
 BoundingBoxComponent get_camera_bb(const CameraView& camera, bool includeMargin = true);
 // Checks if the given bounding box with the given offset is within the view of the camera (AKA, checks for 
 // BB collision with the camera's bounding box)
 bool is_in_view(const CameraView& camera, const BoundingBoxComponent& bb, const Position& pos = {0,0});
+// Returns the world-space box covering everything the camera sees (see get_camera_bb). Compute it once
+// and test it against WorldAABBs with overlapping_aabb, instead of calling is_in_view for each entity.
+WorldAABB get_camera_aabb(const CameraView& camera, bool includeMargin = true);
@@ -26,7 +26,16 @@ struct CollisionShape{
     Vector2 offset;
     virtual inline CollisionShapeType get_type() const{  return CollisionShapeType::NONE;  };
     CollisionShape(const Vector2& offset): offset(offset) {};
+    virtual ~CollisionShape() = default;
     virtual std::unique_ptr<CollisionShape> clone() const = 0; // allows for deep cloning of shapes
+    // Shapes are allocated through util::arena_allocate, so the ones created while a level is
+    // built live in the level's arena (which is what most of a level's allocations are).
+    static void* operator new(size_t size){
+        return util::arena_allocate(size);
+    }
+    static void operator delete(void* ptr){
+        util::arena_deallocate(ptr);
+    }
 };
 
 // Adds the specified position to the offset of the given shape. ShapeType must inherit from CollisionShape.
@@ -0,0 +1,33 @@
+/*
+    FILE: frame_snapshot.h
+    Defines the FrameSnapshot struct, which holds everything needed to draw one frame of a level
+    without touching the level itself, so that a level can be simulated on one thread while the
+    previous frame is drawn on the main thread (see SimulationThread).
+*/
+#pragma once
+#include"raylib.h"
+#include"basic_components.h"
+#include"player_component.h"
+#include"render_queue.h"
+#include<cstddef>
+
+/*
+    Immutable copy of what drawing a frame needs, written by LevelRegistry::write_frame_snapshot.
+    Snapshots are meant to be reused every frame, so that their buffers don't have to be reallocated.
+    Textures are referenced by id, so the level's textures must outlive the snapshots referencing them.
+*/
+struct FrameSnapshot {
+    // Index of the level in its LevelSequence, so that the level is only destroyed once no snapshot
+    // being drawn comes from it (see LevelSequence::release_finished_levels)
+    size_t levelIdx = 0;
+    Camera2D camera = {};
+    // Sprites, particles and tilemaps in view, already sorted
+    RenderQueue queue;
+    // What's needed to draw the player's drag arrow (see draw_player_drag_velocity)
+    PlayerComponent player = {.mouseAnchorPosition = {0,0}, .potentialVelocity = {0,0}, .totalImpulses = 0, .health = PlayerComponent::MAX_HEALTH, .canDrag = false};
+    Position playerPos = {0,0};
+};
+
+// Draws the given frame. Includes a Raylib BeginDrawing() and EndDrawing() call, just like
+// LevelRegistry::draw. Must be called on the main thread.
+void draw_frame_snapshot(FrameSnapshot& frame, bool debugMode = false);
@@ -0,0 +1,138 @@
+/*
+    FILE: job_system.h
+    Defines the job system: a fixed-size pool of worker threads shared by every part of
+    the engine that wants to do work in parallel (systems, particles, level and asset
+    loading,...), so that none of them have to spawn their own threads.
+*/
+#pragma once
+#include<atomic>
+#include<cstddef>
+#include<exception>
+#include<functional>
+#include<future>
+#include<memory>
+#include<mutex>
+#include<type_traits>
+#include<utility>
+#include<vector>
+
+namespace JobSystem {
+
+using JobFunction = std::function<void()>;
+
+/*
+    A unit of work. Tasks can depend on other tasks, forming a task graph: a task only gets
+    scheduled once every task it depends on has finished. Tasks are handled through
+    TaskHandles (shared pointers), so they stay alive for as long as someone needs them.
+*/
+struct Task {
+    JobFunction function;
+    // Number of unfinished prerequisites, plus one while the task hasn't been submitted
+    std::atomic<size_t> pendingDependencies{1};
+    std::atomic<bool> done{false};
+    // If true, the task is run by the main thread in process_main_thread_jobs instead of a worker
+    bool mainThreadOnly = false;
+    // If true, the task is a long job queued apart from the others (see run_in_background)
+    bool background = false;
+    // Exception thrown by the function, rethrown by wait()
+    std::exception_ptr exception;
+    // Tasks waiting for this one to finish. Protected by the mutex.
+    std::vector<std::shared_ptr<Task>> continuations;
+    std::mutex mutex;
+};
+using TaskHandle = std::shared_ptr<Task>;
+
+// Value returned by current_worker_index() for threads that aren't workers.
+inline constexpr size_t NOT_A_WORKER = (size_t)-1;
+
+// Starts the worker threads. If numberWorkers is zero, uses one less than the number of hardware
+// threads, since the main thread also runs jobs while it waits. Must be called from the main thread,
+// which gets registered as such. Does nothing if the job system is already running. Every other
+// function starts the job system with the default settings if it hasn't been started yet.
+void init(size_t numberWorkers = 0);
+
+// Finishes all queued jobs and joins the worker threads.
+void shutdown();
+
+// Returns the number of worker threads (not counting the main thread).
+size_t number_of_workers();
+
+// Returns the index of the calling worker thread, in [0, number_of_workers()), or NOT_A_WORKER.
+size_t current_worker_index();
+
+// Returns true only if called from the thread that called init().
+bool is_main_thread();
+
+/*
+    Creates a task that won't be scheduled until it's submitted. Use add_dependency before
+    submitting it to make it wait for other tasks. Main-thread-only tasks get run by the main
+    thread on its next call to process_main_thread_jobs (or while it waits on a task).
+*/
+TaskHandle create_task(JobFunction function, bool mainThreadOnly = false);
+
+// Makes `task` wait for `prerequisite` to finish. `task` must not have been submitted yet.
+void add_dependency(const TaskHandle& task, const TaskHandle& prerequisite);
+
+// Schedules the task, which will run as soon as all its prerequisites are done.
+void submit(const TaskHandle& task);
+
+// Creates and submits a task with no dependencies.
+TaskHandle run(JobFunction function);
+
+/*
+    Creates and submits a long task with no dependencies (e.g. building or destroying a level). Background
+    tasks go to a queue of their own that only idle workers take from: threads waiting on other tasks never
+    run them, so a short per-frame wait can't end up running a whole level build. Waiting on a background
+    task that no worker has picked up yet runs it on the waiting thread.
+*/
+TaskHandle run_in_background(JobFunction function);
+
+// Creates and submits a task that runs once `before` has finished (a continuation).
+TaskHandle then(const TaskHandle& before, JobFunction function, bool mainThreadOnly = false);
+
+// Returns true if the task has finished running.
+inline bool is_done(const TaskHandle& task){
+    return task->done.load(std::memory_order_acquire);
+}
+
+// Waits until the task is finished, running other jobs in the meantime (main-thread jobs
+// too, if called from the main thread, but never background ones). Rethrows any exception the task threw.
+void wait(const TaskHandle& task);
+
+// Waits until all given tasks are finished. Rethrows the first exception thrown, in order.
+void wait_all(const std::vector<TaskHandle>& tasks);
+
+/*
+    Calls function(chunkBegin, chunkEnd) over chunks of [begin, end) of at most grainSize
+    indices each, in parallel, and returns once they're all done. The calling thread runs
+    chunks too. Chunks are pushed to the calling worker's own queue (or spread over all of
+    them, for non-worker threads), and idle workers steal them.
+*/
+void parallel_for(size_t begin, size_t end, size_t grainSize, const std::function<void(size_t, size_t)>& function);
+
+// Runs every job queued for the main thread. Meant to be called once per frame by the main
+// loop, which is where anything that talks to raylib's window/GPU state needs to happen.
+void process_main_thread_jobs();
+
+// Queues a function to be run by the main thread and returns a future for its result.
+template<class Function>
+auto run_on_main_thread(Function&& function) -> std::future<std::invoke_result_t<Function>> {
+    using ResultType = std::invoke_result_t<Function>;
+    auto packagedTask = std::make_shared<std::packaged_task<ResultType()>>(std::forward<Function>(function));
+    std::future<ResultType> future = packagedTask->get_future();
+    submit(create_task([packagedTask]{ (*packagedTask)(); }, true));
+    return future;
+}
+
+// Same as run_on_main_thread, but waits for the result. If called from the main thread,
+// the function is just called directly.
+template<class Function>
+auto run_on_main_thread_and_wait(Function&& function) -> std::invoke_result_t<Function> {
+    if(is_main_thread()){
+        return function();
+    } else {
+        return run_on_main_thread(std::forward<Function>(function)).get();
+    }
+}
+
+} // namespace JobSystem
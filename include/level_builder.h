@@ -74,7 +74,6 @@ namespace LevelBuilder
     // (not just the error, but object data that needs to be kept alive
     // for the duration of the parsing and processing)
     struct Context {
-        std::ifstream jsonFile; // The file stream from which the level data is taken
         std::map<std::string, entt::entity> entityNames; // Maps the level entity names used in the file to the entity IDs used in the registry
         std::map<std::string, std::vector<TilesetTile>> tilesets; // Maps the tileset names used in the file to the tileset tile data
         Error error;
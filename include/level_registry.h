@@ -14,11 +14,31 @@
 #include"animation_handler.h"
 #include"tileset_component.h"
 #include"rng_component.h"
+#include"particle_generator.h"
+#include"render_queue.h"
+#include"frame_snapshot.h"
+#include"level_snapshot.h"
+#include"name_table.h"
+#include"system_scheduler.h"
+#include"utility/string_hash.h"
+#include<map>
 #include<memory>
+#include<memory_resource>
+#include<string>
+#include<string_view>
 #include<unordered_map>
 #include<utility>
 #include <vector>
 
+// Entity names are looked up by their hash, so that the name only has to be hashed once.
+using EntityNameHash = util::StringHash;
+// Converts a string literal to an entity name hash at compile time, allowing syntax like
+//  entt::entity thing = registry.get_entity("Thing_0"_name);
+// without hashing any strings at runtime.
+constexpr EntityNameHash operator""_name(const char* str, size_t str_size){
+    return util::hash_string(str, str_size);
+}
+
 /*
     Main class that represents a level with all its entities, and allows basic
     manipulation of them. Wraps the entt::registry class, giving it functionality
@@ -33,25 +53,103 @@ class LevelRegistry{
     static inline const std::string CAMERA_ENTITY_NAME = "__CAMERA";
     static inline const std::string INPUT_MANAGER_ENTITY_NAME = "__INPUT";
     static inline const std::string RNG_ENTITY_NAME = "__RNG";
+    // Assets used by every level (see create_player and create_goal)
+    static constexpr const char* PLAYER_SPRITE_FILENAME = "resources/sprites/ball.png";
+    static constexpr const char* PLAYER_HIT_SOUND_FILENAME = "resources/sounds/hit_1.ogg";
+    static constexpr const char* GOAL_SPRITE_FILENAME = "resources/sprites/flag.png";
+    // VoicePool priority of the player's sounds, so that they're never cut off by the level's
+    static constexpr int PLAYER_SOUND_PRIORITY = 10;
+    // Maximum number of particles alive at once in a level, unless the level sets its own.
+    static constexpr size_t DEFAULT_PARTICLE_BUDGET = 8192;
+    // Seed of the level's random stream, unless the level sets its own.
+    static constexpr uint64_t DEFAULT_SEED = 0x5eed;
 
   private:
+    // Arena for the level's small allocations (collision shapes, sprite frame tables, name index
+    // nodes,...), see util::LevelArena. Declared first so that it's destroyed after everything
+    // allocated from it.
+    util::LevelArena arena;
+    // Every entity name in the level, stored once. EntityName components hold handles into it.
+    NameTable names;
     // dynamically allocated registry because the size of entt::registry is ridiculous.
     // Maybe actually just having it as a member would be better? most of the registry's
     // info is on the heap anyway
     std::unique_ptr<entt::registry> registry;
     // Stores the total number of level objects in the registry. What counts as a level
     // object is a little arbitrary, but it mostly just depends on it not being part of the UI.
-    unsigned int numberOfLevelObjects;
-    // Stores all the entity names in a hash map for easy lookup.
-    std::unordered_map<std::string, entt::entity> entityNames;
+    unsigned int numberOfLevelObjects = 0;
+    // Stores all the entity names in a hash map for easy lookup. The map is keyed by the hash
+    // of the name (the name itself is stored in the name table).
+    std::pmr::unordered_map<EntityNameHash, entt::entity, util::PrehashedStringHasher> entityNames;
+    // IDs of the reserved entities, cached when they're created so that the per-frame logic
+    // doesn't have to look them up by name. entt::null until init_level is called.
+    struct ReservedEntities {
+        entt::entity player = entt::null;
+        entt::entity goal = entt::null;
+        entt::entity camera = entt::null;
+        entt::entity inputManager = entt::null;
+        entt::entity rng = entt::null;
+    } reservedEntities;
+    // Ordered index of all entity names, used for prefix searches (see search_entities_by_name).
+    // Kept in sync with entityNames by new_entity and destroy_entity.
+    // The keys point into the name table, which never moves its characters.
+    std::pmr::map<std::string_view, entt::entity> sortedEntityNames;
+    // Returns the handle of the given name, adding it to the name table unless an existing entity already has it.
+    NameHandle intern_name(std::string_view name);
+    // Maps the name's hash to the entity. Throws std::invalid_argument if another entity
+    // with a different name has the same hash.
+    void register_entity_name(entt::entity entity, NameHandle nameHandle);
+    // Creates a new entity with the given (already interned) name and returns its ID.
+    entt::entity new_entity(NameHandle nameHandle);
+    // Runs all the per-frame systems below (see register_systems for which ones run concurrently).
+    // Dynamically allocated because its worker threads need it to stay at the same address.
+    std::unique_ptr<SystemScheduler> scheduler;
+    // State of the level right after it was built, restored when the player resets the level.
+    LevelSnapshot resetSnapshot;
+    // Set by the input system when the player presses reset. The level isn't restored right away
+    // because other systems may be running at the same time, so update() does it after they're done.
+    bool resetRequested = false;
+    // Set by the input system once the player reaches the goal.
+    bool levelComplete = false;
+    // Draw commands of the current frame. Mutable because it's just a reused buffer for draw().
+    mutable RenderQueue renderQueue;
+    // Latest input sample given through set_input, fed to the input manager by the input system.
+    InputSample inputSample;
+    // Maximum number of particles alive at once across all the level's generators (see handle_particles).
+    size_t particleBudget = DEFAULT_PARTICLE_BUDGET;
+    // Seed of the RNG entity's stream, which every other random stream in the level is split from.
+    uint64_t seed = DEFAULT_SEED;
+    // A generator to update in handle_particles, and the most particles it can spawn.
+    struct ParticleUpdate {
+        ParticleGenerator* generator;
+        size_t spawnAllowance;
+        bool visible;
+    };
+    // Reused buffer for handle_particles.
+    std::vector<ParticleUpdate> particleUpdates;
+    // Registers all the per-frame systems in the scheduler, declaring the components they use.
+    void register_systems();
+    // Moves all objects with velocity, accelerating the ones that have an acceleration too.
+    void integrate_motion(float delta);
     // Does the collision logic (detecting and resolving collisions, calling handlers,...)
     void handle_collisions_general();
     // Calls the respective animation handlers to update the sprites of all objects
     void handle_animations(float delta);
+    // Updates all particle generators (spawning, moving and killing particles) in parallel, sharing the
+    // particle budget between them in order of priority. Generators out of the camera's view only get
+    // their clocks advanced (see particle_generator_advance_clock).
+    void handle_particles(float delta);
     // Camera movement, etc.
     void handle_camera(float delta);
     // Handles player input (dragging, pausing,...) and player-specific actions.
     void handle_input_and_player();
+    // Bakes the dirty chunks of the tilemaps within the given view. Draws into render textures, so it
+    // must be called on the main thread, outside of BeginMode2D()...EndMode2D().
+    void bake_visible_tilemaps(const WorldAABB& cameraAABB) const;
+    // Returns true if bake_visible_tilemaps would bake anything. Can be called from any thread.
+    bool has_dirty_visible_tilemaps(const WorldAABB& cameraAABB) const;
+    // Queues the sprites, particles and tilemaps within the given view.
+    void queue_draw_commands(RenderQueue& queue, const WorldAABB& cameraAABB) const;
     // Creates adn sets up the player entity and returns its ID.
     entt::entity create_player(const Position& pos);
     // Creates and sets up the goal entity and returns its ID.
@@ -77,7 +175,6 @@ class LevelRegistry{
     }
     // creates a new entity with the given name and returns its ID
     entt::entity new_entity(const std::string& name);
-    entt::entity new_entity(std::string&& name);
     /*
         creates a new level object with the given name prefix at the given position. the prefix
         will be followed by a number correspondent to the total number of level objects, unless
@@ -86,9 +183,22 @@ class LevelRegistry{
     entt::entity new_level_object(const std::string& namePrefix, const Position& pos = {0,0}, bool uniqueName = false);
     // Gets the entity ID with the given name, if no entity exists with that name, returns entt::null.
     entt::entity get_entity(const std::string& name) const;
-    entt::entity get_entity(std::string&& name) const;
-    // Gets a vector containing all the entity ID's whose names start with prefix.
-    // might not be a good idea to run this while ingame as it can take up a long time.
+    // Same as above, but with an already hashed name (see operator""_name).
+    entt::entity get_entity(EntityNameHash nameHash) const;
+    // Getters for the reserved entities. These don't do any name lookups, so they're
+    // preferable to get_entity(PLAYER_ENTITY_NAME) and the like.
+    inline entt::entity get_player_entity() const { return reservedEntities.player; }
+    inline entt::entity get_goal_entity() const { return reservedEntities.goal; }
+    inline entt::entity get_camera_entity() const { return reservedEntities.camera; }
+    inline entt::entity get_input_manager_entity() const { return reservedEntities.inputManager; }
+    inline entt::entity get_rng_entity() const { return reservedEntities.rng; }
+    // Returns the name of the given entity, or an empty string if it doesn't have one. The returned
+    // view stays valid for as long as the level exists.
+    std::string_view get_entity_name(entt::entity entity) const;
+    // Destroys the given entity, removing its name from the registry's name lookups.
+    void destroy_entity(entt::entity entity);
+    // Gets a vector containing all the entity ID's whose names start with prefix, sorted by name.
+    // Takes O(log n + k) time, with n the total number of named entities and k the number of matches.
     std::vector<entt::entity> search_entities_by_name(const std::string& prefix) const;
 
     CollisionComponent& make_entity_into_static_body(entt::entity entity, const Position& pos, std::vector<LayerType>&& layers);
@@ -119,6 +229,35 @@ class LevelRegistry{
         return registry->try_get<ComponentType>(entity);
     }
 
+    // Sets the maximum number of particles alive at once in the level. When it's reached, generators
+    // spawn fewer particles (or none), lowest priority first (see ParticleSettings::priority).
+    inline void set_particle_budget(size_t budget){
+        particleBudget = budget;
+    }
+    inline size_t get_particle_budget() const {
+        return particleBudget;
+    }
+    // Sets the seed of the level's random numbers, so that playing the level the same way always gives the
+    // same results. Must be called before init_level, which creates the RNG entity.
+    inline void set_seed(uint64_t levelSeed){
+        seed = levelSeed;
+    }
+    inline uint64_t get_seed() const {
+        return seed;
+    }
+    // Returns true once the player has reached the goal.
+    inline bool is_level_complete() const { return levelComplete; }
+    // Writes the current mutable state of the level (see LevelSnapshot) into the given snapshot.
+    void snapshot(LevelSnapshot& snapshot) const;
+    // Restores the level to the state stored in the given snapshot. Must not be called while
+    // the level is being updated.
+    void restore(const LevelSnapshot& snapshot);
+    // Saves the current state of the level as the one resetting goes back to. Called once the
+    // level has been built.
+    void save_reset_state();
+    // Returns the level's arena. Open a util::ArenaScope with it while building the level so that
+    // the level's objects get allocated from it.
+    inline const util::LevelArena& get_arena() const { return arena; }
     // Returns a reference to the wrapped registry.
     entt::registry& get();
     // Returns a *const* reference to the wrapped registry.
@@ -134,9 +273,20 @@ class LevelRegistry{
     // Recalculates the bounding box component of the given entity, in case its collision and/or sprite
     // has been modified. If the entity doesn't have a bounding box yet, it adds it.
     void recalculate_bounding_box(entt::entity entity);
+    // Sets the input state the next update() sees. Input isn't read from raylib by the level itself, so
+    // that it can be updated on any thread. Call it every frame, with sample_input().
+    inline void set_input(const InputSample& input){
+        inputSample = input;
+    }
     // Basic game logic function. Of course, runs 60 times a second.
     void update(float delta);
     // Draws the level to the screen. Includes a Raylib BeginDrawing() and EndDrawing() call, so there's no
     // need to nest the function inside another BeginDrawing() ... EndDrawing(). Runs 60 times a second too.
     void draw(bool debugMode = false) const;
+    // Writes what's needed to draw the current frame into the given snapshot, to be drawn later (possibly
+    // while the level is being updated) with draw_frame_snapshot. Can be called from any thread, but
+    // waits for the main thread to bake the visible tilemaps. Debug overlays aren't included.
+    void write_frame_snapshot(FrameSnapshot& frame) const;
+    // Returns the number of draw commands and texture switches of the last frame drawn.
+    inline const RenderStats& get_render_stats() const { return renderQueue.get_stats(); }
 };
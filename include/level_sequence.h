@@ -0,0 +1,89 @@
+/*
+    FILE: level_sequence.h
+    Defines the LevelSequence class, which plays a list of levels one after the other,
+    building each next level in the background while the current one is being played.
+*/
+#pragma once
+#include"level_registry.h"
+#include"job_system.h"
+#include<memory>
+#include<string>
+#include<vector>
+
+/*
+    Plays a list of level files in order. While a level is being played, the next one is parsed
+    and built into a separate LevelRegistry on a worker thread (only uploading its textures to the
+    GPU is left to the main thread, see AssetPrefetcher), so that moving
+    on to it once the current level is complete is just a move assignment.
+*/
+class LevelSequence {
+  private:
+    std::vector<std::string> levelFilenames;
+    size_t currentLevelIdx = 0;
+    LevelRegistry currentLevel;
+    // Level being built in the background, and the task building it. The level must not be touched
+    // until the task is done. Null if there's no next level.
+    std::unique_ptr<LevelRegistry> nextLevel;
+    JobSystem::TaskHandle nextLevelTask;
+    bool nextLevelFailed = false;
+    bool finished = false;
+    // Levels already completed, kept until nothing can be drawing them anymore (see release_finished_levels)
+    struct FinishedLevel {
+        size_t levelIdx;
+        std::unique_ptr<LevelRegistry> level;
+    };
+    std::vector<FinishedLevel> finishedLevels;
+    // Tasks destroying finished levels in the background
+    std::vector<JobSystem::TaskHandle> levelDestructions;
+
+    // Starts building the level after the current one, if there is one.
+    void start_preloading_next_level();
+  public:
+    // Constructs a sequence with the given level files, in order. Throws std::invalid_argument if it's empty.
+    LevelSequence(std::vector<std::string>&& levelFilenames);
+    // Waits for the levels being built or destroyed in the background, if any, since they reference this object.
+    ~LevelSequence();
+    LevelSequence(const LevelSequence&) = delete;
+    LevelSequence& operator=(const LevelSequence&) = delete;
+
+    // Parses and builds a level from the given file into the given registry. Returns false if there's
+    // an error. Can be called from any thread.
+    static bool build_level_from_file(const char* filename, LevelRegistry& level);
+
+    // Builds the first level on the calling thread and starts preloading the second one. Returns
+    // false if the first level couldn't be built.
+    bool start();
+    // Updates the current level, moving on to the next one once it's complete. If it was the last one
+    // (or the next one couldn't be built), the sequence finishes. Can be called from a thread other than
+    // the main one (see SimulationThread), as long as the main thread keeps processing its jobs.
+    // The completed level is kept alive (its textures might still be drawn from a FrameSnapshot) until
+    // release_finished_levels says it can go.
+    void update(float delta);
+    /*
+        Destroys, in the background, every completed level before the one with the given index, which
+        must be the oldest level anything can still be drawing. Their textures get unloaded on the main
+        thread's next call to JobSystem::process_main_thread_jobs. Must be called from the thread that
+        calls update.
+    */
+    void release_finished_levels(size_t oldestDrawnLevelIdx);
+    // Destroys every level (waiting for the one being built in the background, if any) and finishes the
+    // sequence. Must be called from the main thread before the window and the audio device are closed.
+    void clear();
+    // Draws the current level.
+    inline void draw(bool debugMode = false) const {
+        currentLevel.draw(debugMode);
+    }
+    // Returns the level currently being played. The reference stays valid when moving on to the next
+    // level, but all entities and components from the previous one are gone.
+    inline LevelRegistry& current(){
+        return currentLevel;
+    }
+    // Returns the index of the current level within the list of files.
+    inline size_t current_level_index() const {
+        return currentLevelIdx;
+    }
+    // Returns true once the last level is complete (or a level couldn't be built).
+    inline bool is_finished() const {
+        return finished;
+    }
+};
@@ -0,0 +1,43 @@
+/*
+    FILE: level_snapshot.h
+    Defines LevelSnapshot, an in-memory copy of the mutable state of a level (positions,
+    velocities, player state, particles, RNG state,...) which can be restored later on,
+    e.g. to reset the level without building it again from its file.
+*/
+#pragma once
+#include"entt.hpp"
+#include<cstddef>
+#include<vector>
+
+/*
+    Binary buffer holding a snapshot of a level's registry, written and read through EnTT
+    snapshot archives. Only the components that change during play are stored; everything
+    else (textures, collision shapes, tilemaps, handlers,...) stays shared with the live level,
+    so restoring only overwrites the stored values in the entities that already exist.
+    The buffer keeps its capacity between snapshots, so taking a snapshot again doesn't allocate.
+*/
+class LevelSnapshot {
+  private:
+    std::vector<unsigned char> buffer;
+    friend void take_level_snapshot(const entt::registry& registry, LevelSnapshot& snapshot);
+    friend void restore_level_snapshot(entt::registry& registry, const LevelSnapshot& snapshot);
+  public:
+    // Preallocates the given number of bytes for the snapshot data.
+    inline void reserve(size_t bytes){
+        buffer.reserve(bytes);
+    }
+    // Returns true if no snapshot has been taken into this object yet.
+    inline bool empty() const {
+        return buffer.empty();
+    }
+    // Returns the size, in bytes, of the stored snapshot.
+    inline size_t size() const {
+        return buffer.size();
+    }
+};
+
+// Writes the mutable state of every entity in the registry to the snapshot, overwriting its previous contents.
+void take_level_snapshot(const entt::registry& registry, LevelSnapshot& snapshot);
+// Writes the values stored in the snapshot back to the registry. Entities (or components) that
+// were destroyed after the snapshot was taken are skipped, and ones created afterwards are left as is.
+void restore_level_snapshot(entt::registry& registry, const LevelSnapshot& snapshot);
@@ -0,0 +1,71 @@
+/*
+    FILE: name_table.h
+    Defines the NameTable class, which stores all the entity names of a level in one place
+    so that each name is only stored once and entities can refer to it with a small handle.
+*/
+#pragma once
+#include"utility/string_hash.h"
+#include<cstddef>
+#include<cstdint>
+#include<memory_resource>
+#include<string_view>
+#include<vector>
+
+// Handle to a name stored in a NameTable. Just the index of the name within the table.
+using NameHandle = uint32_t;
+
+/*
+    Append-only table of strings. The characters of every name are stored back to back in large
+    chunks which are never moved or freed until the table is destroyed, so the string_views returned
+    by get() stay valid for as long as the table lives. The hash of every name is stored too, so
+    it's only computed once per name.
+*/
+class NameTable {
+  private:
+    struct Entry {
+        const char* data;
+        uint32_t size;
+        util::StringHash hash;
+    };
+    std::pmr::memory_resource* resource;
+    std::pmr::vector<Entry> entries;
+    // Every chunk allocated so far, to give them back to the resource on destruction
+    std::pmr::vector<std::pair<char*, size_t>> chunks;
+    char* currentChunk = nullptr;
+    size_t currentChunkUsed = 0;
+    size_t currentChunkCapacity = 0;
+
+    // Returns space for `size` characters in the current chunk, starting a new one if it doesn't fit.
+    char* reserve_characters(size_t size);
+    NameHandle add_entry(const char* data, size_t size);
+  public:
+    // Size of each chunk of characters. Names longer than this get a chunk of their own.
+    static constexpr size_t CHUNK_SIZE = 16 * 1024;
+
+    // Constructs an empty table that allocates from the given resource (e.g. a level's arena).
+    explicit NameTable(std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+    ~NameTable();
+    NameTable(NameTable&& other);
+    NameTable& operator=(NameTable&&) = delete;
+    NameTable(const NameTable&) = delete;
+    NameTable& operator=(const NameTable&) = delete;
+
+    // Appends the given name to the table and returns its handle.
+    NameHandle add(std::string_view name);
+    // Appends the name resulting from writing `number` after `prefix` (e.g. "Block_" and 12 give "Block_12"),
+    // without building the whole string anywhere else first.
+    NameHandle add_numbered(std::string_view prefix, unsigned int number);
+
+    // Returns the name with the given handle.
+    inline std::string_view get(NameHandle handle) const {
+        return std::string_view(entries[handle].data, entries[handle].size);
+    }
+    // Returns the hash of the name with the given handle (see util::hash_string).
+    inline util::StringHash get_hash(NameHandle handle) const {
+        return entries[handle].hash;
+    }
+    // Returns the number of names in the table.
+    inline size_t size() const {
+        return entries.size();
+    }
+};
@@ -3,15 +3,22 @@
     Defines a component that acts as a particle generator, where each particle is
     rendered without being its own entiity.
 */
+#pragma once
 #include"basic_components.h"
+#include"bounding_box.h"
 #include"raylib.h"
 #include"particles.h"
 #include"rng_component.h"
 #include"utility.h"
 #include "utility/random_range.h"
 
+#include<cstddef>
+#include<cstdint>
 #include<vector>
 
+// Maximum number of particles a generator can have alive at once.
+inline constexpr size_t MAX_PARTICLES_PER_GENERATOR = 512;
+
 // This struct defines the settings with which particles can spawn. Each range property
 // selects a random value within the range for each particle spawned.
 struct ParticleSettings {
@@ -25,17 +32,29 @@ struct ParticleSettings {
     FloatRange initialRotation; // The initial rotation, in degrees, that a particle will have on spawn
     FloatRange rotationalVelocity; // Constant rotational velocity on each particle
     ColorRange color; // The color applied to the texture upon drawing. Will linearly fade between the colors in the range
+    unsigned int priority = 0; // When the level's particle budget runs low, generators with higher priority get to spawn first
+    bool fadeOut = false; // If true, particles fade out (linearly) over their lifetime
 };
 
 // This is the component in question.
 struct ParticleGenerator {
     ParticleSettings settings;
-    std::vector<Particle> particlePool;
+    ParticlePool particlePool;
     float particleCurrentSpawnTimer; // Timer is negative if disabled. Keeps track of current spawn time
+    // The generator's own random stream, so that generators can be updated in parallel and still give
+    // the same results for the same level seed
+    RNGComponent rng;
+    // Time the particles are evaluated at (see ParticlePool). Advances with every update, and is moved
+    // back every now and then (along with the particles' birth times) so that it stays small.
+    float clock = 0.f;
+    // Clock time by which every particle in the pool is dead
+    float lastDeathTime = 0.f;
 };
 
-// Constructs a new particle generator with the given settings.
-ParticleGenerator new_particle_generator(ParticleSettings&& settings);
+// Constructs a new particle generator with the given settings and random stream (usually split from the
+// level's, see rng_split). Its pool is allocated right away, with room for as many particles as the settings can have alive
+// at once (up to MAX_PARTICLES_PER_GENERATOR).
+ParticleGenerator new_particle_generator(ParticleSettings&& settings, const RNGComponent& rng);
 
 // Enables the given particle generator if it was disabled.
 void particle_generator_enable(ParticleGenerator& particles);
@@ -46,10 +65,41 @@ void particle_generator_disable(ParticleGenerator& particles);
 // Resets the given particle generator, erasing all particles.
 void particle_generator_reset(ParticleGenerator& particles);
 
-// Updates all particles in the given generator's pool (lifetimes, velocities, etc.), spawns new
-// particles if needed and erases particles whose lifetimes have ended. An RNG component is needed
-// for new particles spawned.
-void particle_generator_update(ParticleGenerator& particles, RNGComponent& rng, float delta);
+// Advances the given generator's clock (which moves all of its particles, see ParticlePool), spawns new
+// particles if needed and erases particles whose lifetimes have ended. New particles are generated
+// from the generator's own random stream. At most spawnAllowance particles are spawned (fewer if the
+// pool fills up). Returns the number of particles spawned. Updating different generators at the same
+// time is safe.
+size_t particle_generator_update(ParticleGenerator& particles, float delta, size_t spawnAllowance = SIZE_MAX);
+
+// Cheaper update for generators nobody is looking at: only advances the clock and the spawn timer. Nothing
+// is spawned, and dead particles are only erased once they're all dead (they aren't drawn anyway), so
+// unless that happens this takes constant time. The particles still alive keep moving, since their
+// state only depends on the clock.
+void particle_generator_advance_clock(ParticleGenerator& particles, float delta);
+
+// Returns a box (in world space) which every particle the given generator can spawn stays within for
+// its whole lifetime, with the generator at the given position.
+WorldAABB particle_generator_bounds(const ParticleGenerator& particles, const Position& pos);
+
+// Returns the most particles the given generator can spawn when updated with the given delta: zero if its
+// spawn timer doesn't run out, or as many as a spawn can have (and fit in the pool) if it does. Doesn't
+// change the generator, so the level can split its particle budget before updating them all in parallel.
+size_t particle_generator_max_spawned(const ParticleGenerator& particles, float delta);
+
+// Corners (top left, bottom left, bottom right, top right) and color of the quad of one particle,
+// ready to be drawn.
+struct ParticleQuad {
+    Vector2 corners[4];
+    Color color;
+};
+
+// Appends the quads of all particles in the given generator's pool, with the given position offset,
+// to `quads`. Doesn't touch raylib, so it can be called from any thread.
+void particle_generator_write_quads(const ParticleGenerator& particles, const Position& pos, std::vector<ParticleQuad>& quads);
+
+// Draws the given particle quads with the given texture, all in one batch.
+void draw_particle_quads(const Texture& texture, const ParticleQuad* quads, size_t count);
 
 // Draws all particles in the given generator's pool with the given position offset.
 void particle_generator_draw(const ParticleGenerator& particles, const Position& pos = {0,0});
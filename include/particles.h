@@ -1,49 +1,112 @@
 /*
     FILE: particles.h
-    Defines the Particle class, an object with position, velocity, etc. that
-    isn't processed as a separate entity and instead attached to a ParticleGenerator
-    component.
+    Defines the ParticlePool class, which stores the particles (objects with position, velocity,
+    etc.) of a ParticleGenerator component. Particles aren't processed as separate entities, and
+    are stored as a structure of arrays so that all of a pool's particles are processed at once.
 */
+#pragma once
 #include<raylib.h>
 #include"utility.h"
+#include<cstddef>
+#include<memory>
 
-// Defines the particles generated by the ParticleGenerator component. Texture isn't stored
-// because the texture is part of the ParticleGenerator itself.
-class Particle {
+/*
+    Particles generated by a ParticleGenerator component, stored as one array per property. Particles
+    move with a constant acceleration (the same for the whole pool) and a constant rotational velocity,
+    so only their state when they were spawned is stored, and their state at any later time is computed
+    in closed form (see evaluate). Nothing has to be updated every frame. Texture isn't stored because
+    the texture is part of the ParticleGenerator itself. Positions are relative to the generator, angles
+    are in degrees, times are in seconds on the generator's clock.
+    Pools have a fixed capacity: their memory is allocated once, when they're constructed, and adding
+    particles to a full pool does nothing.
+*/
+class ParticlePool {
   private:
-    Color m_color;
-    Vector2 m_relativePos;
-    Vector2 m_velocity;
-    Vector2 m_acceleration;
-    float m_currentAngle; // in degrees!
-    float m_rotationalVelocity;
-    float m_timeToLive;
-    Particle();
+    // Index of each float array within m_floats
+    enum FloatArray : size_t {
+        POS_X = 0, POS_Y,
+        VEL_X, VEL_Y,
+        ANGLE,
+        ROTATIONAL_VELOCITY,
+        BIRTH_TIME,
+        LIFETIME,
+        NUMBER_FLOAT_ARRAYS
+    };
+    // Every float array, one after the other, m_capacity floats each
+    std::unique_ptr<float[]> m_floats;
+    std::unique_ptr<Color[]> m_colors;
+    size_t m_capacity = 0;
+    size_t m_size = 0;
+
+    inline float* array(FloatArray index){ return m_floats.get() + index * m_capacity; }
+    inline const float* array(FloatArray index) const { return m_floats.get() + index * m_capacity; }
   public:
-    // Constructs a particle with the following initial values.
-    Particle(
+    // Number of bytes each particle takes in total, across all arrays.
+    static constexpr size_t BYTES_PER_PARTICLE = NUMBER_FLOAT_ARRAYS * sizeof(float) + sizeof(Color);
+
+    // Constructs an empty pool with room for the given number of particles.
+    ParticlePool(size_t capacity = 0);
+    // Copies have the same capacity as the original.
+    ParticlePool(const ParticlePool& other);
+    ParticlePool& operator=(const ParticlePool& other);
+    ParticlePool(ParticlePool&& other);
+    ParticlePool& operator=(ParticlePool&& other);
+
+    // Adds a particle spawned at the given time, with the following initial values. Returns false
+    // (without adding it) if the pool is full.
+    bool add(
         const Color& color,
         const Vector2& relativePos,
         const Vector2& velocity,
-        const Vector2& acceleration,
         float angle,
         float rotationalVelocity,
+        float birthTime,
         float lifetime
     );
+    /*
+        Computes the position and angle of every particle at the given time, with the given acceleration:
+          position = spawn position + velocity * t + acceleration * t^2 / 2
+          angle = spawn angle + rotational velocity * t
+        where t is the particle's age. Writes them, and the ages, to the output arrays, which must have
+        room for size() values each. Vectorized, since every particle is computed the same way.
+    */
+    void evaluate(float time, const Vector2& acceleration, float* outX, float* outY, float* outAngle, float* outAge) const;
+    // Removes the particles whose lifetime has ended by the given time, keeping the order of the rest.
+    // Single pass over the pool, without branching on whether each particle is alive.
+    void remove_dead(float time);
+    // Subtracts the given time from every birth time. Used to rebase the generator's clock, so that it
+    // never grows large enough to lose precision.
+    void shift_birth_times(float offset);
+    // Removes every particle.
+    inline void clear(){ m_size = 0; }
+    // Sets the number of particles, leaving the values of the new ones unspecified (they're meant to be
+    // overwritten, see for_each_array). Throws std::length_error if it's greater than the capacity.
+    void resize(size_t size);
+    inline size_t size() const { return m_size; }
+    inline size_t capacity() const { return m_capacity; }
+    inline bool empty() const { return m_size == 0; }
+    inline bool full() const { return m_size == m_capacity; }
+
+    // Getters for what's needed to draw the particles besides evaluate (see particle_generator_write_quads),
+    // one value per particle.
+    inline const float* lifetimes() const { return array(LIFETIME); }
+    inline const Color* colors() const { return m_colors.get(); }
 
-    // Copy and move constructors and assignment operators
-    ;
-    Particle(const Particle&) = default;
-    Particle(Particle&&) = default;
-    Particle& operator=(const Particle& other) = default;
-    Particle& operator=(Particle&& other) = default;
-    // Updates the particle's position, velocity, based on the given frame time.
-    void update(float delta);
-    // Returns true when the particle's lifetime clock has reached zero, as an indicator
-    // that the owning ParticleGenerator should remove it from the pool
-    bool shouldDie() const;
-    // Draws the individual particle with a given texture and global position (the particle's)
-    // position is only relative.
-    // TODO: this ideally should only be done in one draw call. how? idk
-    void draw(const Texture& texture, const Vector2& position) const;
+    // Calls function(data) with a pointer to the start of every array of the pool (float*, or Color* for the
+    // colors), in the same order every time. Each array holds size() values. Used to store and restore pools
+    // as raw bytes (see LevelSnapshot).
+    template<class Function>
+    void for_each_array(Function&& function){
+        for(size_t index = 0; index < NUMBER_FLOAT_ARRAYS; index++){
+            function(array((FloatArray)index));
+        }
+        function(m_colors.get());
+    }
+    template<class Function>
+    void for_each_array(Function&& function) const {
+        for(size_t index = 0; index < NUMBER_FLOAT_ARRAYS; index++){
+            function(array((FloatArray)index));
+        }
+        function((const Color*)m_colors.get());
+    }
 };
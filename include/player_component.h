@@ -31,7 +31,19 @@ struct InputManager{
     InputMap keysLastFrame = 0;
 };
 
+// State of all the inputs at one instant, as read from raylib.
+struct InputSample{
+    Vector2 mouseScreenPosition = {0,0};
+    InputManager::InputMap keys = 0;
+};
+
+// Reads the current state of all the inputs from raylib. Must be called on the main thread.
+InputSample sample_input();
+// Updates the given input manager with the given sample, as if its keys were the ones pressed this
+// instant. Doesn't touch raylib, so it can be called from any thread.
+void apply_input_sample(InputManager& input, const InputSample& sample);
 // Uodates the given input manager, setting the input map to the keys pressed this instant.
+// Same as apply_input_sample(input, sample_input()).
 void update_input(InputManager& input);
 // Checks and returns whether the given input is currently active (being held down).
 bool is_input_active(const InputManager& input, InputManager::Inputs check);
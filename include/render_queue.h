@@ -0,0 +1,101 @@
+/*
+    FILE: render_queue.h
+    Defines the RenderQueue class, which collects everything a level draws in a frame as compact
+    commands, sorts them so that commands using the same texture end up together and then draws
+    them all at once, keeping texture switches (and therefore raylib draw calls) to a minimum.
+    A queue owns all the data its commands need, so it can be filled on one thread and drawn on another.
+*/
+#pragma once
+#include"raylib.h"
+#include"basic_components.h"
+#include"particle_generator.h"
+#include<cstddef>
+#include<cstdint>
+#include<vector>
+
+// Layers commands are drawn in, from the bottom to the top. Commands in a lower layer are always drawn
+// before commands in a higher one. Within a layer, commands are grouped by texture, and commands with the
+// same texture are drawn in the order they were pushed.
+enum class RenderLayer : uint8_t {
+    SPRITES = 0,
+    PARTICLES,
+    TILEMAPS
+};
+
+// Counters for the last frame submitted.
+struct RenderStats {
+    size_t commands = 0;
+    // Number of times the texture changed between consecutive commands. raylib has to issue a draw call
+    // every time the texture changes, so this is also (roughly) the number of draw calls.
+    size_t textureBinds = 0;
+};
+
+/*
+    Per-frame buffer of draw commands. Intended usage, each frame:
+        queue.clear();
+        queue.push_texture(...); queue.push_particles(...); ...
+        queue.sort(); // optional, submit() sorts if needed. Doesn't touch raylib, so can be done on any thread
+        queue.submit(); // between BeginMode2D()...EndMode2D(), on the main thread
+    The buffers keep their capacity between frames, so after the first few frames nothing is allocated.
+*/
+class RenderQueue {
+  public:
+    struct Command {
+        enum class Type : uint8_t {
+            TEXTURE,  // one DrawTexturePro call
+            PARTICLES // every particle of a generator, as quads (see draw_particle_quads)
+        } type;
+        Texture texture;
+        Rectangle source;
+        Rectangle dest;
+        Vector2 origin;
+        float rotation;
+        Color tint;
+        // only for PARTICLES: range of the command's quads in the queue's particle quad buffer
+        uint32_t firstQuad;
+        uint32_t quadCount;
+    };
+  private:
+    // Sort key: layer (8 bits) | texture id (24 bits) | order of submission (32 bits)
+    struct SortEntry {
+        uint64_t key;
+        uint32_t commandIdx;
+    };
+    std::vector<Command> commands;
+    std::vector<SortEntry> sortEntries;
+    std::vector<SortEntry> sortScratch; // second buffer for the radix sort
+    std::vector<ParticleQuad> particleQuads;
+    RenderStats lastStats;
+    bool sorted = true;
+
+    void push(RenderLayer layer, const Command& command);
+  public:
+    // Removes all commands. Doesn't free memory.
+    void clear();
+    // Queues a DrawTexturePro call with the given arguments.
+    void push_texture(RenderLayer layer, const Texture& texture, const Rectangle& source, const Rectangle& dest,
+                      const Vector2& origin = {0,0}, float rotation = 0, Color tint = WHITE);
+    // Queues a SpriteSheet's current frame, drawn like draw_sprite does.
+    void push_sprite(const SpriteSheet& sprite, const SpriteTransform& transform, const Position& pos);
+    // Queues drawing all particles of the given generator with the given position offset. Their quads
+    // are computed right away, so the generator can change (or be destroyed) before submit().
+    void push_particles(const ParticleGenerator& particles, const Position& pos);
+    // Sorts the queued commands by layer and texture (LSD radix sort, one byte per pass, skipping the bytes
+    // all keys share). Does nothing if they're already sorted.
+    void sort();
+    // Sorts (if needed) and calls f(command) for every queued command, in the order submit() draws them.
+    template<class F>
+    void for_each_command(F&& f){
+        sort();
+        for(const SortEntry& entry : sortEntries){
+            f(static_cast<const Command&>(commands[entry.commandIdx]));
+        }
+    }
+    // Sorts (if needed) and draws every queued command. Meant to be used between Raylib's BeginDrawing()...EndDrawing()
+    // functions (and BeginMode2D()...EndMode2D() if needed). The commands stay queued until clear().
+    void submit();
+    // Returns the counters of the last submit() call.
+    inline const RenderStats& get_stats() const { return lastStats; }
+    // Returns the number of commands queued.
+    inline size_t size() const { return commands.size(); }
+};
@@ -3,32 +3,44 @@
     Defines a component to handle any random output in the game
 */
 #pragma once
-#include<random>
-//#include some more files maybe
+#include<cstddef>
+#include<cstdint>
 
 /*
     Component that is in charge of generating the random numbers for basically anything.
-    Includes a LCE for random ints and an std::uniform_real_distribution for random floats.
+    Made of RNG_LANES xoshiro128** generators (lanes), each one 2^64 steps ahead of the previous one,
+    which are all stepped at once (their state is stored one array per state word, so the step vectorizes).
+    Single numbers are handed out one at a time from the last step's outputs, and the batch functions
+    (random_ints, random_floats) fill arrays with whole steps. Either way, the same seed always gives the
+    same sequence of numbers.
+    Trivially copyable, so it can be stored as raw bytes (see LevelSnapshot).
 */
+inline constexpr size_t RNG_LANES = 8;
 struct RNGComponent{
-    std::minstd_rand intGenerator;
-    std::uniform_real_distribution<float> floatGenerator;
+    uint32_t state[4][RNG_LANES];
+    // Outputs of the last step of every lane, used from bufferIndex onwards
+    uint32_t buffer[RNG_LANES];
+    uint32_t bufferIndex;
 };
 
-// Constructs and returns an RNG component with a random seed. The seed is 'randomized' through 
-// memory allocation of an std::string and type punning, so it may be UB on some devices. works on my machine tho
-RNGComponent new_rng_component();
-// Safe version of the above function, just uses time(nullptr) to get a pseudo-random seed 
+// Creates an RNG component with a pseudo-random seed, taken from time(nullptr)
 RNGComponent new_rng_component_safe();
 // Creates an RNG component with an already known seed
-RNGComponent new_rng_component(unsigned int seed);
+RNGComponent new_rng_component(uint64_t seed);
+
+// Moves every lane of the given RNG 2^96 steps ahead, discarding any numbers left from the last step.
+void rng_jump(RNGComponent& rng);
+// Returns a new RNG that starts where the given one is now, and jumps the given one ahead (see rng_jump),
+// so that they never give the same numbers (up to 2^64 steps each, and 2^32 splits). Used to give every
+// thread or object its own stream.
+RNGComponent rng_split(RNGComponent& rng);
 
 // Gets a random integer with no restrictions
 unsigned int random_int(RNGComponent& rng);
 
 // Both these functions get a random integer in the range [0, upperBound), but the function not
-// tagged as "_fast" performs checks to ensure the numbers are being picked from a range the size of
-// which is a multiple of upperBound
+// tagged as "_fast" is unbiased (Lemire's method: it rerolls the rare outputs that would make some
+// numbers more likely than others), while the "_fast" one never rerolls
 unsigned int random_int(RNGComponent& rng, unsigned int upperBound);
 unsigned int random_int_fast(RNGComponent& rng, unsigned int upperBound);
 
@@ -37,12 +49,15 @@ unsigned int random_int_fast(RNGComponent& rng, unsigned int upperBound);
 unsigned int random_int(RNGComponent& rng, unsigned int lowerBound, unsigned int upperBound);
 unsigned int random_int_fast(RNGComponent& rng, unsigned int lowerBound, unsigned int upperBound);
 
-// Gets a random float in the range [0.0, 1.0]
+// Gets a random float in the range [0.0, 1.0)
 float random_float(RNGComponent& rng);
-// Gets a random float in the range [0.0, upperBound]
+// Gets a random float in the range [0.0, upperBound)
 float random_float(RNGComponent& rng, float upperBound);
-// Gets a random float in the range [lowerBound, upperBound]
+// Gets a random float in the range [lowerBound, upperBound)
 float random_float(RNGComponent& rng, float lowerBound, float upperBound);
 
-
-
+// Batch versions of random_int and random_float: fill the given array with `count` random numbers, the
+// same ones as `count` calls to the single versions would give (in the same order).
+void random_ints(RNGComponent& rng, unsigned int* out, size_t count);
+void random_floats(RNGComponent& rng, float* out, size_t count);
+void random_floats(RNGComponent& rng, float* out, size_t count, float lowerBound, float upperBound);
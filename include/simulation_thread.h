@@ -0,0 +1,95 @@
+/*
+    FILE: simulation_thread.h
+    Defines the SimulationThread class, which updates a LevelSequence on its own thread while the
+    main thread draws, pipelining simulation and rendering.
+*/
+#pragma once
+#include"level_sequence.h"
+#include"frame_snapshot.h"
+#include"utility/triple_buffer.h"
+#include<atomic>
+#include<condition_variable>
+#include<exception>
+#include<functional>
+#include<mutex>
+#include<thread>
+#include<vector>
+
+/*
+    Runs the updates of a level sequence on a dedicated thread, so that the simulation of frame N+1
+    happens while the main thread draws frame N. After every update, the simulation thread writes a
+    FrameSnapshot of the current level and hands it to the main thread through a triple buffer, so
+    neither thread waits for the other to draw or update (the simulation thread only waits for the
+    main thread to ask for the next update, which paces it to the frame rate, and for the main thread
+    to bake the tilemap chunks in view on the rare frames where one of them changed).
+    Everything that touches the level from the main thread (input, debug controls,...) has to go through
+    push_command. Intended usage, on the main thread:
+      SimulationThread simulation{levels};
+      simulation.start();
+      while(...){
+          JobSystem::process_main_thread_jobs();
+          simulation.push_command([input = sample_input()](LevelSequence& levels){ levels.current().set_input(input); });
+          simulation.request_update(GetFrameTime());
+          simulation.draw();
+      }
+      simulation.stop();
+*/
+class SimulationThread {
+  public:
+    // Something to do to the level sequence on the simulation thread, before its next update.
+    using Command = std::function<void(LevelSequence&)>;
+  private:
+    LevelSequence& levels;
+    util::TripleBuffer<FrameSnapshot> frames;
+    // Whether the main thread has picked up a frame yet
+    bool hasFrame = false;
+    // Level of the frame the main thread is drawing. Earlier levels can be destroyed.
+    std::atomic<size_t> drawnLevelIdx{0};
+    std::thread thread;
+
+    // Protect everything the main thread hands to the simulation thread
+    std::mutex mutex;
+    std::condition_variable updateRequested;
+    std::vector<Command> pendingCommands;
+    // Time to simulate in the next update. Accumulates if the simulation falls behind.
+    float pendingDelta = 0;
+    bool pendingUpdate = false;
+    bool stopRequested = false;
+
+    // Set once the level sequence is finished
+    std::atomic<bool> finished{false};
+    // Set once the simulation thread has exited
+    std::atomic<bool> exited{false};
+    // Exception thrown on the simulation thread, rethrown by stop()
+    std::exception_ptr exception;
+
+    // Body of the simulation thread.
+    void run();
+    // Writes a snapshot of the current level and hands it to the main thread.
+    void write_frame();
+  public:
+    // The sequence must have been started, and must outlive this object.
+    SimulationThread(LevelSequence& levels);
+    // Stops the thread if it's running. Exceptions from the simulation thread are lost, call stop() to get them.
+    ~SimulationThread();
+    SimulationThread(const SimulationThread&) = delete;
+    SimulationThread& operator=(const SimulationThread&) = delete;
+
+    // Writes the first frame and starts the simulation thread. Must be called from the main thread.
+    void start();
+    // Queues a command to be run on the simulation thread before its next update.
+    void push_command(Command command);
+    // Asks the simulation thread to update the level sequence by the given time.
+    void request_update(float delta);
+    // Draws the latest frame the simulation thread has finished (see draw_frame_snapshot). Must be
+    // called from the main thread.
+    void draw(bool debugMode = false);
+    // Returns true once the level sequence is finished (or the simulation thread failed).
+    inline bool is_finished() const {
+        return finished.load(std::memory_order_acquire);
+    }
+    // Stops the simulation thread and waits for it to exit, processing main-thread jobs in the meantime
+    // since it may be waiting on them. Rethrows any exception thrown on the simulation thread. Must be
+    // called from the main thread. Does nothing if the thread isn't running.
+    void stop();
+};
@@ -4,17 +4,20 @@
     An entity can have multiple sounds associated via the same component.
 */
 #pragma once
-#include "sound_handle.h"
+#include "raylib.h"
 #include "sound_loader.h"
+#include "utility/string_hash.h"
 
 #include <vector>
 
 // Sounds are indexed by a number for easy key comparison.
-using SoundKey = size_t;
+using SoundKey = util::StringHash;
 // This converts a string literal to a sound key so syntax like
 //  try_play_sound(soundComponent, "hit"_sound);
-// is valid.
-SoundKey operator""_sound(const char* str, size_t str_size);
+// is valid. The key is hashed at compile time.
+constexpr SoundKey operator""_sound(const char* str, size_t str_size){
+    return util::hash_string(str, str_size);
+}
 
 // Same as operator""_sound but for std::strings.
 SoundKey to_key(const std::string& str);
@@ -23,12 +26,20 @@ SoundKey to_key(const char* str);
 
 // This component stores a set of sounds indexed by sound keys.
 // The storage is done by a std::vector instead of an std::map or similar
-// because most entities will have very few sounds so it would be overkill
+// because most entities will have very few sounds so it would be overkill.
+// Only the ids of the sounds in the SoundLoader are stored (holding a reference
+// each); they're played through the VoicePool, which all entities share.
 struct SoundComponent {
-    std::vector<SoundHandle> sounds;
+    std::vector<SoundId> sounds;
     std::vector<SoundKey> keys;
+    // Priority of the entity's sounds in the VoicePool
+    int priority = 0;
 
     SoundComponent();
+    SoundComponent(const SoundComponent& other);
+    SoundComponent(SoundComponent&& other);
+    SoundComponent& operator=(const SoundComponent& other);
+    SoundComponent& operator=(SoundComponent&& other);
     ~SoundComponent();
 };
 
@@ -41,7 +52,9 @@ void add_sound_to_component(SoundComponent& sound, const char* soundFilename, So
 void remove_sound_from_component(SoundComponent& sound, SoundKey key);
 
 // Plays the sound indexed by the given sound key in the component, if it exists.
-void try_play_sound(SoundComponent& sound, SoundKey key);
+void try_play_sound(const SoundComponent& sound, SoundKey key);
+// Same as try_play_sound, but the sound is heard from the given position (see VoicePool::PlayParams).
+void try_play_sound(const SoundComponent& sound, SoundKey key, Vector2 position);
 
 // Returns true only if the given sound component has the sound key passed as parameter.
 bool has_sound(const SoundComponent& sound, SoundKey key);
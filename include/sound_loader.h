@@ -6,38 +6,41 @@
 #pragma once
 #include <raylib.h>
 #include <string>
-#include <unordered_map>
-#include "sound_handle.h"
+#include <optional>
+#include "asset_registry.h"
 
 namespace SoundLoader {
 
-// This struct maintains info about a specific sound handle.
-struct SoundInfo {
-    size_t refCount;
-    SoundHandle sound;
-    SoundInfo() = delete;
-    SoundInfo(const char* filepath);
-    SoundInfo(const SoundInfo&) = default;
-    SoundInfo(SoundInfo&&) = default;
-};
+// Every sound loaded through the SoundLoader, by filepath. Sounds can be loaded from worker threads too
+// (e.g. while a level is built in the background). Unlike textures, they don't need the main thread,
+// since raylib's audio module has its own locking.
+inline AssetRegistry<Sound> _sounds;
 
-inline std::unordered_map<std::string, SoundInfo> _soundFileMap;
+// Searches the sound filepath in the sound registry, increasing its reference count and returning its
+// id if it's found. If the sound is not loaded yet, it loads it and returns its id. Sounds are played
+// through the VoicePool.
+SoundId load_or_get_sound(const char* filepath);
 
-// Searches the sound filepath in the internal sound file map. Returns a copy
-// of the attached sound handle if it's found. If the sound is not loaded yet,
-// it loads it and returns the handle.
-SoundHandle load_or_get_sound(const char* filepath);
+// Registers a sound already loaded from the given file (e.g. by an AssetPrefetcher), with a reference
+// count of 1, and returns its id. If the file was loaded in the meantime, the given sound is unloaded and
+// the registered one is acquired instead.
+SoundId register_loaded_sound(const char* filepath, Sound sound);
 
-// Decreases the sound's reference count, unloading it if it reaches zero.
-// It has to search linearly through the whole map so this should be done within loadtimes.
-void return_sound(SoundHandle& sound);
+// Decreases the sound's reference count, unloading it (and stopping every voice playing it) if it
+// reaches zero. Does nothing if the sound isn't loaded.
+void return_sound(SoundId sound);
 
-// Searches the given sound handle in the map linearly. If it exists, the function
-// returns a copy of the sound. If it doesn't, it throws an exception. Also shouldn't be
-// done often.
-SoundHandle get_sound_copy(const SoundHandle& sound);
+// Increases the given sound's reference count and returns its id. Throws std::invalid_argument if the
+// sound isn't loaded through the SoundLoader.
+SoundId get_sound_copy(SoundId sound);
+
+// Returns the given sound, or nothing if it isn't loaded.
+std::optional<Sound> get_sound(SoundId sound);
 
 // Returns the reference count associated to the sound with the given filename.
 size_t _get_sound_ref_count(const char* filepath);
 
+// Returns the number of sounds loaded and the memory they take.
+AssetStats get_sound_stats();
+
 }
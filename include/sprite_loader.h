@@ -5,36 +5,75 @@
 */
 #pragma once
 #include"raylib.h"
-#include<memory>
+#include"asset_registry.h"
 #include<string>
-#include<unordered_map>
 
 namespace SpriteLoader{
-    // (private) Struct that saves the info and reference count of a specific texture.
-    struct TextureInfo{
-        size_t refCount;
+    // Every texture loaded through the SpriteLoader, by filepath (or name, see register_texture) and by id.
+    inline AssetRegistry<Texture> _textures;
+
+    // A texture and the area of it holding an image: the whole texture, unless the image was packed into
+    // a texture atlas page.
+    struct TextureRegion {
         Texture texture;
-        TextureInfo() = default;
-        TextureInfo(const char* filepath); 
-        // Loads a texture from the corresponding filepath. Sets its reference 
-        // count to 1 automatically because it's assumed that constructing a 
-        // texture means it's going to get used right now.
-        TextureInfo(TextureInfo&&) = default;
-        ~TextureInfo();
-      private:
-        // Field that controls whether the destructor should unload the texture when it's called. 
-        // Used to prevent premature unloading when moving textures from local scope to global scope.
-        bool unloadOnDestruct = false; 
-        friend Texture load_new_texture_always(const char*); 
-        friend Texture load_or_get_texture(const char*);
+        Rectangle source;
     };
-    inline std::unordered_map<std::string, TextureInfo> _spriteFileMap;
+
+    /*
+        Loads a texture from the given file (through AssetFiles, so it can come from the asset archive).
+        Can be called from any thread: on a worker thread, the image is decoded on the calling thread and only the GPU upload is handed to the main thread
+        (see JobSystem::run_on_main_thread), so this waits until the main loop gets to it.
+    */
+    Texture load_texture_from_any_thread(const char* filepath);
+    // Unloads the given texture, right away if called from the main thread or on the main
+    // thread's next call to JobSystem::process_main_thread_jobs otherwise.
+    void unload_texture_from_any_thread(Texture texture);
+    // Uploads the given image as a new texture, on the main thread like load_texture_from_any_thread.
+    // The texture isn't registered anywhere (see register_texture).
+    Texture load_texture_from_image_any_thread(const Image& image);
+
+    /*
+        Registers an already loaded texture (e.g. a texture atlas page) under the given name, made unique
+        by appending underscores like load_new_texture_always does, with the given ref count. From then on
+        it's managed like any other texture, so it's unloaded once it's been returned `refCount` times.
+    */
+    Texture register_texture(const char* name, Texture texture, size_t refCount = 1);
+
+    /*
+        Registers a texture already loaded from the given file (e.g. by an AssetPrefetcher), with a ref count
+        of 1, and returns it. If the file was loaded in the meantime, the given texture is unloaded and the
+        registered one is copied and returned instead.
+    */
+    Texture register_loaded_texture(const char* filepath, Texture texture);
+
+    /*
+        Records that the image from the given file was packed into the given area of an atlas page (which
+        must be registered, see register_texture), so that load_or_get_texture_region finds it there while
+        the page is loaded. Can be called from any thread.
+    */
+    void register_atlas_region(const char* filepath, Texture page, Rectangle area);
+
+    // Returns true if the image from the given file is in a loaded atlas page.
+    bool has_atlas_region(const char* filepath);
+
+    /*
+        Returns the atlas page holding the image from the given file and its area in it, increasing the
+        page's ref count (so return_texture(region.texture) gives it back). If the image isn't in an atlas,
+        does the same as load_or_get_texture and the area is the whole texture.
+    */
+    TextureRegion load_or_get_texture_region(const char* filepath);
+
+    /*
+        Returns the name the texture was registered with (the filepath it was loaded from, unless it was
+        loaded with load_new_texture_always or register_texture), or an empty string if it isn't registered.
+    */
+    std::string get_texture_name(Texture texture);
 
     /* 
         Gets a newly loaded texture independently of if it's already loaded that filename.
         Probably not recommended to use this, because:
             1. it's the whole thing we're trying to avoid with the SpriteLoader
-            2. it appends underscores to the filename to get a unique name in the _spriteFileMap
+            2. it appends underscores to the filename to get a unique name in the registry
     */
     Texture load_new_texture_always(const char* filepath);
 
@@ -45,17 +84,23 @@ namespace SpriteLoader{
     Texture load_or_get_texture(const char* filepath);
 
     /*
-        Decreases the texture's ref count. To find the texture it linear-searches through the texture
-        map so it's probably best not to do this on the fly. Of course, if the ref count goes to 0,
-        the texture is unloaded.
+        Decreases the texture's ref count, finding it by its id (a hash lookup). Of course, if the ref
+        count goes to 0, the texture is unloaded. Does nothing if the texture isn't registered.
     */
     void return_texture(Texture texture);
 
     /*
-        Copies the texture (i.e., increases its ref count). This one also does a linear search.
+        Copies the texture (i.e., increases its ref count). Throws std::invalid_argument if the texture
+        isn't registered.
     */
     Texture get_texture_copy(Texture texture);
 
+    // Returns the handle of the given texture in the registry, or an invalid handle if it isn't registered.
+    TextureId get_texture_id(Texture texture);
+
+    // Returns the number of textures loaded and the (GPU) memory they take.
+    AssetStats get_texture_stats();
+
     /*
         Don't know if this is useful at all honestly. Does what it says on the tin
     */
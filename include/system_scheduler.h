@@ -0,0 +1,78 @@
+/*
+    FILE: system_scheduler.h
+    Defines the scheduler that runs the level's systems (movement, collisions, animations,...)
+    every frame. Each system declares which components it reads and writes, and systems that
+    don't conflict with each other get run at the same time on the job system's workers.
+*/
+#pragma once
+#include"entt.hpp"
+#include<cstddef>
+#include<string>
+#include<type_traits>
+#include<vector>
+
+class LevelRegistry;
+
+// Function that runs one system over the whole level for one frame.
+using SystemFunction = void(*)(LevelRegistry& level, float delta);
+
+// Empty tag types used to declare the components a system reads and writes. Intended syntax:
+//   scheduler.add_system(registry, "animations", &animate, SystemReads<AnimationHandler>{}, SystemWrites<SpriteSheet>{});
+template<class... Components> struct SystemReads {};
+template<class... Components> struct SystemWrites {};
+
+/*
+    Runs a list of systems once per frame. Two systems conflict if one of them writes a component
+    the other one reads or writes; conflicting systems always run in the order they were added,
+    and the rest are free to run concurrently. This forms a dependency graph (DAG) which gets
+    turned into a JobSystem task graph every frame, so every system runs on a worker as soon
+    as its dependencies are done (or on the main thread, if it's marked as main-thread-only).
+
+    Systems that run concurrently must not create or destroy entities or add/remove components,
+    since that isn't thread-safe in EnTT. They also shouldn't touch components they don't declare.
+*/
+class SystemScheduler {
+  private:
+    struct SystemInfo {
+        std::string name;
+        SystemFunction function;
+        std::vector<entt::id_type> reads;
+        std::vector<entt::id_type> writes;
+        bool mainThreadOnly;
+    };
+    std::vector<SystemInfo> systems;
+    // Dependency graph: for each system, the systems that must run after it.
+    // Rebuilt when the list of systems changes.
+    std::vector<std::vector<size_t>> dependents;
+    bool graphOutdated = true;
+
+    void add_system_info(SystemInfo&& info);
+    void build_graph();
+    bool conflicting(const SystemInfo& system1, const SystemInfo& system2) const;
+  public:
+
+    /*
+        Adds a system at the end of the list. The storages of every declared component are
+        created in the registry right away, since creating them while systems are running
+        concurrently isn't safe.
+    */
+    template<class... Reads, class... Writes>
+    void add_system(entt::registry& registry, const char* name, SystemFunction function,
+                    SystemReads<Reads...>, SystemWrites<Writes...>, bool mainThreadOnly = false){
+        (registry.storage<std::remove_const_t<Reads>>(), ...);
+        (registry.storage<std::remove_const_t<Writes>>(), ...);
+        add_system_info(SystemInfo{
+            .name = name,
+            .function = function,
+            .reads = {entt::type_hash<std::remove_const_t<Reads>>::value()...},
+            .writes = {entt::type_hash<std::remove_const_t<Writes>>::value()...},
+            .mainThreadOnly = mainThreadOnly
+        });
+    }
+
+    // Runs every system once over the given level, returning once they're all done. Can be called
+    // from any thread, but main-thread-only systems only run once the main thread processes its jobs
+    // (see JobSystem::process_main_thread_jobs). If any system throws, the exception is rethrown here
+    // after the rest of the frame's systems finish.
+    void run(LevelRegistry& level, float delta);
+};
@@ -0,0 +1,68 @@
+/*
+    FILE: texture_atlas.h
+    Defines the texture atlas builder, which packs the small textures used by a level's sprites and
+    tiles into a few large textures (pages), so that drawing them doesn't need a texture switch (and
+    therefore a new draw call) every time a different sprite is drawn.
+*/
+#pragma once
+#include"raylib.h"
+#include<cstddef>
+#include<vector>
+
+namespace TextureAtlas {
+    // Maximum width and height of an atlas page. Pages are cropped to the area actually used.
+    inline constexpr int PAGE_SIZE = 2048;
+    // Textures wider or taller than this are left on their own, since they gain little from batching.
+    inline constexpr int MAX_PACKED_TEXTURE_SIZE = 512;
+    // Empty pixels left between packed textures, so that sampling near the edge of one never picks up its neighbours.
+    inline constexpr int PADDING = 2;
+
+    /*
+        Skyline bottom-left rectangle packer. Keeps the "skyline" formed by the top edges of the
+        rectangles placed so far as a list of horizontal segments, and places each new rectangle at
+        the position where its bottom edge ends up the lowest (then leftmost).
+    */
+    class SkylinePacker {
+      private:
+        struct Segment {
+            int x;
+            int y;
+            int width;
+        };
+        std::vector<Segment> skyline;
+        int width;
+        int height;
+        int usedWidth = 0;
+        int usedHeight = 0;
+
+        // Returns the y at which a rectangle of the given size fits if its left edge is placed at
+        // the start of segment `idx`, or -1 if it doesn't fit there.
+        int fit(size_t idx, int rectWidth, int rectHeight) const;
+      public:
+        SkylinePacker(int width, int height);
+
+        // Finds a place for a rectangle of the given size. Returns false (leaving x and y untouched)
+        // if there's no space left for it.
+        bool insert(int rectWidth, int rectHeight, int& x, int& y);
+
+        // Width and height of the smallest area starting at (0,0) that contains every rectangle inserted.
+        inline int used_width() const { return usedWidth; }
+        inline int used_height() const { return usedHeight; }
+    };
+
+    // Where an image ended up in the atlas.
+    struct Placement {
+        bool isPacked = false; // false if the image was left out
+        size_t page = 0;
+        int x = 0;
+        int y = 0;
+    };
+
+    /*
+        Packs the given images into atlas pages, copying their pixels into one image per page, and outputs
+        where each one ended up (placements[i] for images[i]). Images that aren't R8G8B8A8 or are too large
+        are left out. Works on the CPU only, so it can run on any thread; uploading the pages is up to the
+        caller (see AssetPrefetcher::upload). The returned pages must be unloaded with UnloadImage.
+    */
+    std::vector<Image> build_pages(const std::vector<Image>& images, std::vector<Placement>& placements);
+}
@@ -6,6 +6,8 @@
 #include"utility.h"
 #include"collision_component.h"
 #include"sprite_loader.h"
+#include"bounding_box.h"
+#include"render_queue.h"
 #include<unordered_map>
 #include<vector>
 
@@ -18,6 +20,9 @@ using TileID = size_t;
 struct TilesetTile {
     CollisionComponent collision;
     Texture texture;
+    // Area of the texture that holds the tile's image: the whole texture, unless it's been packed
+    // into a texture atlas page (see SpriteLoader::load_or_get_texture_region)
+    Rectangle source;
     TileID id;
 
     enum class TileCollisionPreset {
@@ -29,7 +34,7 @@ struct TilesetTile {
     };
 
     // Constructs an empty invalid tile.
-    TilesetTile() : collision(), texture(), id(-1) {}
+    TilesetTile() : collision(), texture(), source(), id(-1) {}
 
     // Constructs a tile whose texture is the image included in the filename and
     // whose collision is a rectangle as large as the texture.
@@ -51,6 +56,37 @@ struct TilesetTile {
 };
 
 
+/*
+    Cache of the tilemap already drawn into render textures, one per square chunk of
+    TILESET_CHUNK_SIZE x TILESET_CHUNK_SIZE tiles, so that drawing a tilemap takes one
+    quad per chunk instead of one per tile. Chunks get marked dirty whenever a tile inside
+    them changes, and they're redrawn (baked) the next time tileset_bake_dirty_chunks is
+    called. The render textures are unloaded on destruction (on the main thread, see
+    SpriteLoader::unload_texture_from_any_thread), so this is move-only.
+*/
+struct TilesetChunkCache {
+    std::vector<RenderTexture2D> chunks; // chunks[chunkRow * chunkCols + chunkCol], id 0 if not baked yet
+    std::vector<bool> dirty;
+    size_t chunkRows = 0;
+    size_t chunkCols = 0;
+    // Size of the tilemap when the chunks were allocated. If the map gets resized, every chunk is reallocated.
+    size_t mapRows = 0;
+    size_t mapCols = 0;
+
+    TilesetChunkCache() = default;
+    ~TilesetChunkCache();
+    TilesetChunkCache(const TilesetChunkCache&) = delete;
+    TilesetChunkCache& operator=(const TilesetChunkCache&) = delete;
+    TilesetChunkCache(TilesetChunkCache&& other);
+    TilesetChunkCache& operator=(TilesetChunkCache&& rhs);
+
+    // Unloads every chunk, so they all get reallocated and baked again.
+    void clear();
+};
+
+// Number of tiles on each side of a baked chunk of a tilemap.
+inline constexpr size_t TILESET_CHUNK_SIZE = 32;
+
 /*
     Main component that handles both the list of available tiles and also the whole tilemap.
 */
@@ -70,6 +106,11 @@ struct TilesetComponent {
     // a common divisor of them.
     Vector2 tileSize;
 
+    // Baked chunks of the tilemap. Mutable because baking doesn't change what the tilemap looks like,
+    // it only happens when the tilemap gets drawn. Any change to `map` (or `tiles`) done without the
+    // tileset_* functions must be followed by a call to tileset_mark_all_dirty.
+    mutable TilesetChunkCache chunkCache;
+
     ;// I don't know why the copy constructor and assignment operator are deleted,
     ;// but i don't think they're necessary either.
     TilesetComponent() = default;
@@ -140,6 +181,29 @@ void tileset_fill_tiles(TilesetComponent& tileset, size_t beginRow, size_t endRo
 //       loadtime so it doesn't need to run fast.
 void tileset_get_complete_collision(const TilesetComponent& tileset, CollisionComponent& collision);
 
-// Draws the tilemap to the screen using each tile type's included texture. Meant
-// to be used between Raylib's BeginDrawing()...EndDrawing() functions.
-void draw_tileset(const TilesetComponent& tileset, const Position& pos);
+// Marks the chunk containing the tile at (row, col) as needing to be baked again.
+void tileset_mark_dirty(const TilesetComponent& tileset, size_t row, size_t col);
+
+// Marks every chunk of the tilemap as needing to be baked again.
+void tileset_mark_all_dirty(const TilesetComponent& tileset);
+
+// Outputs the range of rows [beginRow, endRow) and columns [beginCol, endCol) of the tilemap (placed
+// at `pos`) whose tiles overlap the given world-space box, e.g. the camera's view (see get_camera_aabb).
+void tileset_get_tiles_in_area(const TilesetComponent& tileset, const Position& pos, const WorldAABB& area,
+                               size_t& beginRow, size_t& endRow, size_t& beginCol, size_t& endCol);
+
+// Redraws every dirty chunk of the tilemap (placed at `pos`) that overlaps `view` into its render
+// texture. Must be called from the main thread and outside of BeginMode2D()...EndMode2D(), since
+// drawing to a render texture resets the camera transform (LevelRegistry::draw calls it right
+// before BeginDrawing()).
+void tileset_bake_dirty_chunks(const TilesetComponent& tileset, const Position& pos, const WorldAABB& view);
+
+// Returns true if tileset_bake_dirty_chunks would bake anything with the same arguments. Only reads the
+// tilemap, so it can be called from any thread that's allowed to read it.
+bool tileset_has_dirty_chunks(const TilesetComponent& tileset, const Position& pos, const WorldAABB& view);
+
+// Queues drawing the part of the tilemap (placed at `pos`) that overlaps `view` (usually the camera's
+// view, see get_camera_aabb) in the TILEMAPS layer of the given render queue, one quad per baked chunk.
+// Chunks that haven't been baked yet are drawn tile by tile with each tile type's texture instead,
+// only iterating through the tiles in view.
+void draw_tileset(const TilesetComponent& tileset, const Position& pos, const WorldAABB& view, RenderQueue& queue);
@@ -11,3 +11,6 @@
 #include"utility/raylib_draw_util.h"
 #include"utility/color_util.h"
 #include"utility/random_range.h"
+#include"utility/string_hash.h"
+#include"utility/simd_util.h"
+#include"utility/arena.h"
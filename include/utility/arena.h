@@ -0,0 +1,91 @@
+#pragma once
+#include<cassert>
+#include<cstddef>
+#include<memory>
+#include<memory_resource>
+#include<new>
+
+namespace util {
+
+/*
+    Monotonic arena that owns (almost) all the small allocations of a level: collision shapes,
+    sprite frame tables, name index nodes,... Deallocating from it does nothing, and the whole
+    arena is released at once when it's destroyed, so building and tearing down a level doesn't
+    go through the general-purpose allocator tens of thousands of times.
+
+    Everything allocated from an arena must be destroyed before the arena itself.
+*/
+class LevelArena {
+  private:
+    // Heap-allocated so that its address doesn't change when the arena (i.e, the level) is moved
+    std::unique_ptr<std::pmr::monotonic_buffer_resource> resource;
+  public:
+    // Size of the first block the arena allocates. Later blocks grow geometrically.
+    static constexpr size_t DEFAULT_INITIAL_SIZE = 64 * 1024;
+
+    LevelArena(size_t initialSize = DEFAULT_INITIAL_SIZE)
+        : resource{std::make_unique<std::pmr::monotonic_buffer_resource>(initialSize)} {}
+
+    // Returns the memory resource to use with std::pmr containers.
+    inline std::pmr::memory_resource* get_resource() const {
+        return resource.get();
+    }
+};
+
+// Arena that arena_allocate takes memory from on the current thread. Set through ArenaScope.
+inline thread_local std::pmr::memory_resource* _currentArena = nullptr;
+
+/*
+    Makes every arena_allocate call done on this thread take memory from the given arena for as
+    long as the object lives. Scopes can be nested. Intended syntax:
+      {
+          util::ArenaScope scope{level.get_arena()};
+          ... // build the level
+      }
+*/
+class ArenaScope {
+  private:
+    std::pmr::memory_resource* previousArena;
+  public:
+    ArenaScope(const LevelArena& arena) : previousArena{_currentArena} {
+        _currentArena = arena.get_resource();
+    }
+    ~ArenaScope(){
+        _currentArena = previousArena;
+    }
+    ArenaScope(const ArenaScope&) = delete;
+    ArenaScope& operator=(const ArenaScope&) = delete;
+};
+
+// (private) Stored right before every block returned by arena_allocate, to know where it came from.
+struct alignas(std::max_align_t) _ArenaAllocationHeader {
+    std::pmr::memory_resource* arena; // null if allocated from the heap
+};
+
+/*
+    Allocates memory from the current thread's arena (see ArenaScope), or from the global heap if
+    there isn't one. Either way, the memory is freed with arena_deallocate, which doesn't need to know
+    where it came from, so objects allocated like this can be freed from any thread. The alignment
+    can't be greater than alignof(std::max_align_t).
+*/
+inline void* arena_allocate(size_t size, size_t alignment = alignof(std::max_align_t)){
+    assert(alignment <= alignof(_ArenaAllocationHeader));
+    size_t totalSize = sizeof(_ArenaAllocationHeader) + size;
+    std::pmr::memory_resource* arena = _currentArena;
+    void* block = (arena != nullptr) ? arena->allocate(totalSize, alignof(_ArenaAllocationHeader)) : ::operator new(totalSize);
+    _ArenaAllocationHeader* header = new(block) _ArenaAllocationHeader{arena};
+    return header + 1;
+}
+
+// Frees memory allocated with arena_allocate. Does nothing if it came from an arena or is null.
+inline void arena_deallocate(void* ptr){
+    if(ptr == nullptr){
+        return;
+    }
+    _ArenaAllocationHeader* header = static_cast<_ArenaAllocationHeader*>(ptr) - 1;
+    if(header->arena == nullptr){
+        ::operator delete(header);
+    }
+}
+
+}
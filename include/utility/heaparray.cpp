@@ -1,15 +1,37 @@
 #include <stdexcept>
+#include <new>
 #include"heaparray.h"
+#include"arena.h"
 
 #ifndef USMG_HEAPARRAY_CPP
 #define USMG_HEAPARRAY_CPP
 
 namespace util {
+// Allocates the array through arena_allocate, so that arrays created while building a level
+// live in the level's arena (see ArenaScope).
+template<class TYPE>
+TYPE* HeapArray<TYPE>::allocate_data(SizeType size){
+    TYPE* data = static_cast<TYPE*>(arena_allocate(size * sizeof(TYPE), alignof(TYPE)));
+    for (SizeType i = 0; i < size; ++i) {
+        new(&data[i]) TYPE();
+    }
+    return data;
+}
+
+template<class TYPE>
+void HeapArray<TYPE>::free_data(TYPE* data, SizeType size){
+    if (data == nullptr) return;
+    for (SizeType i = 0; i < size; ++i) {
+        data[i].~TYPE();
+    }
+    arena_deallocate(data);
+}
+
 // Constructor with size and optional fill value
 template<class TYPE>
 HeapArray<TYPE>::HeapArray(SizeType size, const TYPE& fill) : size(size) {
     if (size == 0) throw std::invalid_argument("Size cannot be zero");
-    __data__ = new TYPE[size];
+    __data__ = allocate_data(size);
     for (SizeType i = 0; i < size; ++i) {
         __data__[i] = fill;
     }
@@ -18,7 +40,7 @@ HeapArray<TYPE>::HeapArray(SizeType size, const TYPE& fill) : size(size) {
 // Constructor from initializer list
 template<class TYPE>
 HeapArray<TYPE>::HeapArray(const std::initializer_list<TYPE>& initList) : size(initList.size()) {
-    __data__ = new TYPE[size];
+    __data__ = allocate_data(size);
     SizeType i = 0;
     for(auto itr = initList.begin(); itr != initList.end() && i < size; ++itr){
         __data__[i] = *itr; i++;
@@ -28,7 +50,7 @@ HeapArray<TYPE>::HeapArray(const std::initializer_list<TYPE>& initList) : size(i
 // Copy constructor
 template<class TYPE>
 HeapArray<TYPE>::HeapArray(const HeapArray<TYPE>& other) : size(other.size) {
-    __data__ = new TYPE[size];
+    __data__ = allocate_data(size);
     for (SizeType i = 0; i < size; ++i) {
         __data__[i] = other.__data__[i];
     }
@@ -43,7 +65,7 @@ HeapArray<TYPE>::HeapArray(HeapArray<TYPE>&& other) : size(other.size), __data__
 // Destructor
 template<class TYPE>
 HeapArray<TYPE>::~HeapArray() {
-    delete[] __data__;
+    free_data(__data__, size);
 }
 
 // Copy assignment
@@ -63,7 +85,7 @@ template<class TYPE>
 HeapArray<TYPE>& HeapArray<TYPE>::operator=(HeapArray<TYPE>&& rhs) {
     if (this != &rhs) {
         if (size != rhs.size) throw std::runtime_error("Cannot assign arrays of different sizes");
-        delete[] __data__;
+        free_data(__data__, size);
         __data__ = rhs.__data__;
         rhs.__data__ = nullptr;
     }
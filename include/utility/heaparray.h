@@ -12,6 +12,8 @@ class HeapArray{
   private:
     typedef unsigned long SizeType;
     TYPE* __data__;
+    static TYPE* allocate_data(SizeType size);
+    static void free_data(TYPE* data, SizeType size);
 
   public:
     const SizeType size;
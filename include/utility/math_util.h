@@ -1,14 +1,14 @@
 #pragma once
 #include<cmath>
+#include<stdlib.h>
 
 static const float PI_F = 3.14159265358979323846264338327950288419716f;
 static const float TAU_F = 6.28318530717958647692528676655900576839433f;
 static const float RAD_2_DEG_FACTOR = 57.29577951308232087679815481410517033240547f;
 static const double DEG_2_RAD_FACTOR = 0.017453292519943295769236907684886127134428;
 
-inline float abs(float x){
-    return (x >= 0) ? x : -x;
-}
+// abs(float) comes from here: the C++ <stdlib.h> brings every std::abs overload into the global
+// namespace. Defining our own clashes with it as soon as anything includes <stdlib.h> (e.g. <immintrin.h>).
 
 inline float max(float x, float y){
     return (x < y) ? y : x;
@@ -82,8 +82,8 @@ class Matrix {
         size_t minRows = std::min(newRows, m_rows);
         size_t minCols = std::min(newCols, m_cols);
         for(size_t i = 0; i < minRows; i++){
-            for(size_t j = 0; j < minCols; i++){
-                newBuffer[i*newRows + j] = m_vec[i*m_rows + j];
+            for(size_t j = 0; j < minCols; j++){
+                newBuffer[i*newCols + j] = m_vec[i*m_cols + j];
             }
         }
         m_vec = std::move(newBuffer);
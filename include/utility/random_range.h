@@ -4,7 +4,9 @@
 #include "vector2_util.h"
 #include "color_util.h"
 
+#include<algorithm>
 #include<cassert>
+#include<cstddef>
 
 struct IntRange {
     int min;
@@ -33,6 +35,10 @@ struct FloatRange {
     float get_random(RNGComponent& rng) const {
         return random_float(rng, min, max);
     }
+    // Fills the given array with `count` random values (see random_floats)
+    void get_random(RNGComponent& rng, float* out, size_t count) const {
+        random_floats(rng, out, count, min, max);
+    }
 };
 
 struct Vec2Range {
@@ -45,6 +51,11 @@ struct Vec2Range {
     Vector2 get_random(RNGComponent& rng) const {
         return Vector2{random_float(rng, min.x, max.x), random_float(rng, min.y, max.y)};
     }
+    // Fills the given arrays with the components of `count` random vectors, all the x components first
+    void get_random(RNGComponent& rng, float* outX, float* outY, size_t count) const {
+        random_floats(rng, outX, count, min.x, max.x);
+        random_floats(rng, outY, count, min.y, max.y);
+    }
 };
 
 struct ColorRange {
@@ -55,4 +66,15 @@ struct ColorRange {
     Color get_random(RNGComponent& rng) const {
         return lerp(from, to, random_float(rng));
     }
+    // Fills the given array with `count` random colors
+    void get_random(RNGComponent& rng, Color* out, size_t count) const {
+        float factors[64];
+        for(size_t begin = 0; begin < count; begin += 64){
+            size_t batchSize = std::min(count - begin, (size_t)64);
+            random_floats(rng, factors, batchSize);
+            for(size_t i = 0; i < batchSize; i++){
+                out[begin + i] = lerp(from, to, factors[i]);
+            }
+        }
+    }
 };
@@ -0,0 +1,21 @@
+/*
+    FILE: rlgl_subset.h
+    Declares the few functions of raylib's rlgl module (the immediate-mode layer below raylib's
+    shapes and textures drawing functions) that the game uses directly. They're part of libraylib,
+    but rlgl.h itself isn't shipped with the headers in include/, so the declarations are copied
+    here. They must match the raylib version in lib/ (currently 5.6).
+*/
+#pragma once
+
+#define RL_QUADS 0x0007 // GL_QUADS
+
+extern "C" {
+    void rlBegin(int mode);                                                    // Initialize drawing mode (how to organize vertex)
+    void rlEnd(void);                                                          // Finish vertex providing
+    void rlVertex2f(float x, float y);                                         // Define one vertex (position) - 2 float
+    void rlTexCoord2f(float x, float y);                                       // Define one vertex (texture coordinate) - 2 float
+    void rlNormal3f(float x, float y, float z);                                // Define one vertex (normal) - 3 float
+    void rlColor4ub(unsigned char r, unsigned char g, unsigned char b, unsigned char a); // Define one vertex (color) - 4 byte
+    void rlSetTexture(unsigned int id);                                        // Set current texture for render batch and check buffers limits
+    bool rlCheckRenderBatchLimit(int vCount);                                  // Check internal buffer overflow for a given number of vertex
+}
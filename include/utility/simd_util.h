@@ -0,0 +1,30 @@
+#pragma once
+#include<cstddef>
+#ifdef __AVX2__
+#include<immintrin.h>
+#endif
+
+namespace util {
+
+/*
+    Computes dst[i] += src[i] * scale for every i in [0, count). When compiled with AVX2
+    (-mavx2) it processes 8 floats per iteration and finishes the remaining ones with a
+    scalar loop. Multiplication and addition are kept separate (no FMA) so both paths give
+    exactly the same results.
+*/
+inline void add_scaled(float* __restrict dst, const float* __restrict src, float scale, size_t count){
+    size_t i = 0;
+#ifdef __AVX2__
+    const __m256 scaleVec = _mm256_set1_ps(scale);
+    for(; i + 8 <= count; i += 8){
+        __m256 dstVec = _mm256_loadu_ps(dst + i);
+        __m256 srcVec = _mm256_loadu_ps(src + i);
+        _mm256_storeu_ps(dst + i, _mm256_add_ps(dstVec, _mm256_mul_ps(srcVec, scaleVec)));
+    }
+#endif
+    for(; i < count; i++){
+        dst[i] += src[i] * scale;
+    }
+}
+
+}
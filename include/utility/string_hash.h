@@ -0,0 +1,38 @@
+#pragma once
+#include<cstddef>
+#include<cstdint>
+#include<string>
+
+namespace util {
+
+// Hash type used for every hashed string in the game (sound keys, entity names,...)
+using StringHash = uint64_t;
+
+/*
+    64-bit FNV-1a hash. It's constexpr so that string literals can be hashed at compile
+    time (see operator""_sound and operator""_name) and it gives the exact same result
+    at runtime, so a key hashed from a string read from a level file matches a key
+    hashed from a literal in the code.
+*/
+constexpr StringHash hash_string(const char* str, size_t size){
+    StringHash hash = 14695981039346656037ull;
+    for(size_t i = 0; i < size; i++){
+        hash ^= (StringHash)(unsigned char)str[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+inline StringHash hash_string(const std::string& str){
+    return hash_string(str.data(), str.size());
+}
+
+// Hasher for unordered containers whose keys are already StringHashes, so they don't
+// get hashed a second time.
+struct PrehashedStringHasher {
+    constexpr size_t operator()(StringHash hash) const {
+        return (size_t)hash;
+    }
+};
+
+}
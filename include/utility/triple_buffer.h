@@ -0,0 +1,65 @@
+#pragma once
+#include<atomic>
+#include<cstdint>
+
+namespace util {
+
+/*
+    Lock-free triple buffer to pass values from one writer thread to one reader thread. The writer
+    fills write_buffer() and publishes it, the reader picks up the latest published value with
+    update_read_buffer() and reads it through read_buffer(). Neither side ever waits for the other:
+    there are three buffers, one owned by each side and one in the middle, and publishing or picking
+    up a value is just swapping a buffer with the middle one. If the writer publishes several times
+    before the reader picks up, only the latest value is seen.
+    Intended usage:
+      // writer thread                         // reader thread
+      fill(buffer.write_buffer());             buffer.update_read_buffer();
+      buffer.publish();                        use(buffer.read_buffer());
+    The buffers are reused, so their contents (and capacity) stay around between publications.
+*/
+template<class T>
+class TripleBuffer {
+  private:
+    // Set in the middle index when the middle buffer holds a value the reader hasn't picked up yet
+    static constexpr uint8_t NEW_VALUE_BIT = 4;
+    static constexpr uint8_t INDEX_MASK = 3;
+
+    T buffers[3];
+    // Index of the middle buffer, plus NEW_VALUE_BIT
+    std::atomic<uint8_t> middle{1};
+    // Only touched by the writer
+    uint8_t writeIdx = 0;
+    // Only touched by the reader
+    uint8_t readIdx = 2;
+  public:
+    TripleBuffer() = default;
+    TripleBuffer(const TripleBuffer&) = delete;
+    TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+    // (writer) Returns the buffer to fill. It's never read by the reader until publish() is called.
+    inline T& write_buffer(){
+        return buffers[writeIdx];
+    }
+    // (writer) Makes the write buffer the latest value, and gives the writer a new buffer to fill.
+    inline void publish(){
+        uint8_t previous = middle.exchange(writeIdx | NEW_VALUE_BIT, std::memory_order_acq_rel);
+        writeIdx = previous & INDEX_MASK;
+    }
+    // (reader) Switches the read buffer to the latest published value. Returns false (keeping the
+    // current read buffer) if nothing has been published since the last call.
+    inline bool update_read_buffer(){
+        if((middle.load(std::memory_order_relaxed) & NEW_VALUE_BIT) == 0){
+            return false;
+        }
+        uint8_t previous = middle.exchange(readIdx, std::memory_order_acq_rel);
+        readIdx = previous & INDEX_MASK;
+        return true;
+    }
+    // (reader) Returns the value picked up by the last update_read_buffer() call. The reader has
+    // exclusive access to it until the next call.
+    inline T& read_buffer(){
+        return buffers[readIdx];
+    }
+};
+
+}
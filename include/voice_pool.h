@@ -0,0 +1,65 @@
+/*
+    FILE: voice_pool.h
+    Defines the VoicePool module, which plays every sound in the game through a fixed set of voices
+    shared by all entities, so that the number of sounds playing (and of raylib sound aliases) never
+    depends on how many entities can make a sound.
+*/
+#pragma once
+#include"raylib.h"
+#include"asset_registry.h"
+#include<cstddef>
+
+namespace VoicePool {
+
+// Number of voices, i.e. of sounds that can play at once.
+inline constexpr size_t MAX_VOICES = 16;
+// Most voices a single sound can take at once. Playing it again once it has them all restarts its oldest one.
+inline constexpr size_t MAX_VOICES_PER_SOUND = 4;
+// Playing a sound again less than this many seconds after it last started doesn't start another voice (the
+// latest one just gets louder if needed), so bursts of the same sound don't eat up or thrash the voices.
+inline constexpr float MIN_RESTART_INTERVAL = 0.03f;
+// Distance from the listener at which positional sounds can no longer be heard, unless set_listener says otherwise.
+inline constexpr float DEFAULT_AUDIBLE_DISTANCE = 800.f;
+
+// How to play a sound.
+struct PlayParams {
+    // Sounds with a higher priority can take the voices of the ones with a lower priority when every
+    // voice is busy. Sounds never take the voice of a sound with a higher priority.
+    int priority = 0;
+    float volume = 1.f;
+    // If true, the sound gets quieter the further `position` is from the listener, and isn't played at
+    // all if it's out of the audible distance.
+    bool isPositional = false;
+    Vector2 position = {0, 0};
+};
+
+// Counters of what the pool has done so far, for debugging.
+struct VoiceStats {
+    size_t activeVoices = 0;
+    size_t aliasesLoaded = 0; // Sound aliases alive right now (at most one per voice)
+    size_t played = 0;
+    size_t merged = 0; // Not played because the same sound had just started (see MIN_RESTART_INTERVAL)
+    size_t culled = 0; // Not played because they were out of the audible distance
+    size_t stolen = 0; // Played by taking the voice of another sound
+    size_t dropped = 0; // Not played because every voice had a sound with a higher priority
+};
+
+// Sets where positional sounds are heard from (e.g. the center of the camera), and how far they can be heard.
+void set_listener(Vector2 position, float audibleDistance = DEFAULT_AUDIBLE_DISTANCE);
+
+/*
+    Plays the given sound (loaded by the SoundLoader) on a free voice, or steals the least important
+    busy voice: the one with the lowest priority, then the quietest, then the oldest. Returns false if
+    the sound wasn't played (culled, dropped, or not loaded). Can be called from any thread.
+*/
+bool play(SoundId sound, const PlayParams& params = PlayParams{});
+
+// Stops every voice playing the given sound and unloads their aliases of it. The SoundLoader calls this
+// before unloading a sound.
+void stop_sound(SoundId sound);
+// Stops every voice and unloads every alias. Must be called before closing the audio device.
+void clear();
+
+VoiceStats get_stats();
+
+} // namespace VoicePool
@@ -0,0 +1,153 @@
+#include"asset_archive.h"
+#include"utility/string_hash.h"
+#include<algorithm>
+#include<climits>
+#include<cstring>
+#include<fstream>
+#if defined(__unix__) || defined(__APPLE__)
+#include<fcntl.h>
+#include<sys/mman.h>
+#include<sys/stat.h>
+#include<unistd.h>
+#define ASSET_ARCHIVE_USE_MMAP
+#endif
+
+AssetArchive::~AssetArchive(){
+    close();
+}
+
+// Maps the whole file (or reads it into memory allocated with new[], without mmap). Returns null if it can't.
+static const unsigned char* map_file(const char* filepath, size_t& outSize){
+#ifdef ASSET_ARCHIVE_USE_MMAP
+    int file = ::open(filepath, O_RDONLY);
+    if(file < 0){
+        return nullptr;
+    }
+    struct stat fileStat;
+    void* bytes = MAP_FAILED;
+    if(fstat(file, &fileStat) == 0 && fileStat.st_size > 0){
+        bytes = mmap(nullptr, fileStat.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+    }
+    ::close(file); // the mapping stays valid
+    if(bytes == MAP_FAILED){
+        return nullptr;
+    }
+    outSize = fileStat.st_size;
+    return (const unsigned char*)bytes;
+#else
+    std::ifstream file(filepath, std::ios::binary | std::ios::ate);
+    if(!file){
+        return nullptr;
+    }
+    size_t size = file.tellg();
+    unsigned char* bytes = new unsigned char[size];
+    file.seekg(0);
+    if(!file.read((char*)bytes, size)){
+        delete[] bytes;
+        return nullptr;
+    }
+    outSize = size;
+    return bytes;
+#endif
+}
+
+// Returns true if `size` bytes starting at `offset` are inside a file of `fileSize` bytes (without
+// computing offset + size, which can wrap around in a corrupt archive).
+static bool is_range_in_file(uint64_t offset, uint64_t size, size_t fileSize){
+    return offset <= fileSize && size <= fileSize - offset;
+}
+
+// Returns true if the given entry only points inside the file, and its payload is as large as its
+// info says (decoded payloads are used straight from the file, so they'd be read past its end otherwise).
+static bool is_entry_valid(const ArchiveEntry& entry, const ArchiveHeader& header, size_t fileSize){
+    if(!is_range_in_file(entry.dataOffset, entry.dataSize, fileSize) ||
+       !is_range_in_file(header.pathsOffset + entry.pathOffset, entry.pathSize, fileSize)){
+        return false;
+    }
+    switch(entry.type){
+      case ArchiveEntryType::FILE:
+        return true;
+      case ArchiveEntryType::IMAGE_RGBA8: {
+        uint64_t width = entry.info[0];
+        uint64_t height = entry.info[1];
+        // divided rather than multiplied, since the product can wrap around
+        uint64_t rowSize = width * 4;
+        return width > 0 && height > 0 && width <= INT_MAX && height <= INT_MAX &&
+               entry.dataSize % rowSize == 0 && entry.dataSize / rowSize == height;
+      }
+      case ArchiveEntryType::WAVE_PCM: {
+        uint64_t frameCount = entry.info[0];
+        uint64_t sampleSize = entry.info[2];
+        uint64_t channels = entry.info[3];
+        bool isSampleSizeValid = (sampleSize == 8 || sampleSize == 16 || sampleSize == 32);
+        if(!isSampleSizeValid || channels == 0){
+            return false;
+        }
+        uint64_t frameSize = channels * (sampleSize / 8);
+        return entry.dataSize % frameSize == 0 && entry.dataSize / frameSize == frameCount;
+      }
+    }
+    return false; // unknown type
+}
+
+bool AssetArchive::open(const char* filepath){
+    close();
+    m_bytes = map_file(filepath, m_size);
+    if(m_bytes == nullptr){
+        return false;
+    }
+    ArchiveHeader header;
+    bool isValid = (m_size >= sizeof(header));
+    if(isValid){
+        std::memcpy(&header, m_bytes, sizeof(header));
+        isValid = std::memcmp(header.magic, ARCHIVE_MAGIC, sizeof(header.magic)) == 0
+               && header.version == ARCHIVE_VERSION
+               && header.entriesOffset % alignof(ArchiveEntry) == 0
+               && is_range_in_file(header.entriesOffset, (uint64_t)header.entryCount * sizeof(ArchiveEntry), m_size)
+               && header.pathsOffset <= m_size;
+    }
+    if(!isValid){
+        close();
+        return false;
+    }
+    m_entries = (const ArchiveEntry*)(m_bytes + header.entriesOffset);
+    m_entryCount = header.entryCount;
+    m_paths = (const char*)(m_bytes + header.pathsOffset);
+    // entries pointing outside the file would only be found out when they're read, so they're checked now
+    for(uint32_t i = 0; i < m_entryCount; i++){
+        if(!is_entry_valid(m_entries[i], header, m_size)){
+            close();
+            return false;
+        }
+    }
+    return true;
+}
+
+void AssetArchive::close(){
+    if(m_bytes != nullptr){
+#ifdef ASSET_ARCHIVE_USE_MMAP
+        munmap((void*)m_bytes, m_size);
+#else
+        delete[] m_bytes;
+#endif
+    }
+    m_bytes = nullptr;
+    m_size = 0;
+    m_entries = nullptr;
+    m_entryCount = 0;
+    m_paths = nullptr;
+}
+
+const ArchiveEntry* AssetArchive::find(std::string_view path) const {
+    util::StringHash hash = util::hash_string(path.data(), path.size());
+    const ArchiveEntry* end = m_entries + m_entryCount;
+    const ArchiveEntry* entry = std::lower_bound(m_entries, end, hash, [](const ArchiveEntry& entry, util::StringHash hash){
+        return entry.pathHash < hash;
+    });
+    for(; entry != end && entry->pathHash == hash; entry++){
+        if(this->path(*entry) == path){
+            return entry;
+        }
+    }
+    return nullptr;
+}
@@ -0,0 +1,88 @@
+#include"asset_files.h"
+#include<cstring>
+#include<fstream>
+#include<iterator>
+
+namespace AssetFiles {
+
+bool mount_archive(const char* filepath){
+    return _archive.open(filepath);
+}
+
+void unmount_archive(){
+    _archive.close();
+}
+
+// Returns the archive entry of the given file, or null if there's no archive or it doesn't have it.
+static const ArchiveEntry* find_in_archive(const char* filepath){
+    return _archive.is_open() ? _archive.find(filepath) : nullptr;
+}
+
+AssetImage load_image(const char* filepath){
+    const ArchiveEntry* entry = find_in_archive(filepath);
+    if(entry == nullptr){
+        return AssetImage{.image = LoadImage(filepath), .ownsData = true};
+    }
+    const unsigned char* data = _archive.data(*entry);
+    if(entry->type == ArchiveEntryType::IMAGE_RGBA8){
+        // raylib only reads the pixels when uploading or copying them
+        Image image = {
+            .data = (void*)data,
+            .width = (int)entry->info[0],
+            .height = (int)entry->info[1],
+            .mipmaps = 1,
+            .format = PIXELFORMAT_UNCOMPRESSED_R8G8B8A8
+        };
+        return AssetImage{.image = image, .ownsData = false};
+    }
+    return AssetImage{.image = LoadImageFromMemory(GetFileExtension(filepath), data, entry->dataSize), .ownsData = true};
+}
+
+void unload_image(AssetImage& image){
+    if(image.ownsData){
+        UnloadImage(image.image);
+    }
+    image = AssetImage{};
+}
+
+AssetWave load_wave(const char* filepath){
+    const ArchiveEntry* entry = find_in_archive(filepath);
+    if(entry == nullptr){
+        return AssetWave{.wave = LoadWave(filepath), .ownsData = true};
+    }
+    const unsigned char* data = _archive.data(*entry);
+    if(entry->type == ArchiveEntryType::WAVE_PCM){
+        Wave wave = {
+            .frameCount = entry->info[0],
+            .sampleRate = entry->info[1],
+            .sampleSize = entry->info[2],
+            .channels = entry->info[3],
+            .data = (void*)data
+        };
+        return AssetWave{.wave = wave, .ownsData = false};
+    }
+    return AssetWave{.wave = LoadWaveFromMemory(GetFileExtension(filepath), data, entry->dataSize), .ownsData = true};
+}
+
+void unload_wave(AssetWave& wave){
+    if(wave.ownsData){
+        UnloadWave(wave.wave);
+    }
+    wave = AssetWave{};
+}
+
+bool load_file(const char* filepath, std::string& out){
+    const ArchiveEntry* entry = find_in_archive(filepath);
+    if(entry != nullptr){
+        out.assign((const char*)_archive.data(*entry), entry->dataSize);
+        return true;
+    }
+    std::ifstream file(filepath, std::ios::binary);
+    if(!file){
+        return false;
+    }
+    out.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    return true;
+}
+
+} // namespace AssetFiles
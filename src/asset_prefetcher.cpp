@@ -0,0 +1,150 @@
+#include"asset_prefetcher.h"
+#include"asset_files.h"
+#include"sprite_loader.h"
+#include"sound_loader.h"
+#include"texture_atlas.h"
+#include<string>
+
+AssetPrefetcher::~AssetPrefetcher(){
+    release();
+}
+
+JobSystem::TaskHandle AssetPrefetcher::prefetch_texture(const std::string& filepath){
+    unpackableFiles.insert(filepath);
+    return request_texture(filepath);
+}
+
+JobSystem::TaskHandle AssetPrefetcher::prefetch_texture_region(const std::string& filepath){
+    return request_texture(filepath);
+}
+
+JobSystem::TaskHandle AssetPrefetcher::request_texture(const std::string& filepath){
+    if(SpriteLoader::_get_texture_ref_count(filepath.c_str()) > 0 || SpriteLoader::has_atlas_region(filepath.c_str()) ||
+       !requestedFiles.insert(filepath).second){
+        return nullptr;
+    }
+    PendingTexture& pending = pendingTextures.emplace_back();
+    pending.filepath = filepath;
+    pending.decode = JobSystem::run([&pending]{
+        pending.image = AssetFiles::load_image(pending.filepath.c_str());
+        // atlas pages are R8G8B8A8 (images stored decoded in the archive already are)
+        if(pending.image.ownsData && IsImageValid(pending.image.image)){
+            ImageFormat(&pending.image.image, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+        }
+    });
+    return pending.decode;
+}
+
+JobSystem::TaskHandle AssetPrefetcher::prefetch_sound(const std::string& filepath){
+    if(SoundLoader::_get_sound_ref_count(filepath.c_str()) > 0 || !requestedFiles.insert(filepath).second){
+        return nullptr;
+    }
+    PendingSound& pending = pendingSounds.emplace_back();
+    pending.filepath = filepath;
+    pending.decode = JobSystem::run([&pending]{
+        AssetFiles::AssetWave wave = AssetFiles::load_wave(pending.filepath.c_str());
+        if(IsWaveValid(wave.wave)){
+            pending.sound = LoadSoundFromWave(wave.wave);
+        }
+        AssetFiles::unload_wave(wave);
+    });
+    return pending.decode;
+}
+
+// Waits for every decode task of the given pending assets.
+template<class Pending>
+static void wait_for_decodes(const std::deque<Pending>& pendingAssets){
+    std::vector<JobSystem::TaskHandle> decodes;
+    decodes.reserve(pendingAssets.size());
+    for(const Pending& pending : pendingAssets){
+        decodes.push_back(pending.decode);
+    }
+    JobSystem::wait_all(decodes);
+}
+
+void AssetPrefetcher::upload(){
+    wait_for_decodes(pendingTextures);
+    wait_for_decodes(pendingSounds);
+    // packing happens before anything is uploaded, so that packed images are only uploaded as part of their page
+    std::vector<Image> packableImages(pendingTextures.size());
+    size_t packableCount = 0;
+    for(size_t i = 0; i < pendingTextures.size(); i++){
+        if(unpackableFiles.find(pendingTextures[i].filepath) == unpackableFiles.end()){
+            packableImages[i] = pendingTextures[i].image.image;
+            packableCount += IsImageValid(packableImages[i]);
+        }
+    }
+    std::vector<TextureAtlas::Placement> placements(pendingTextures.size());
+    std::vector<Image> pageImages;
+    if(packableCount >= 2){ // otherwise there's nothing to gain
+        pageImages = TextureAtlas::build_pages(packableImages, placements);
+    }
+
+    // one trip to the main thread for every texture, instead of one per texture
+    std::vector<Texture> uploaded(pendingTextures.size());
+    std::vector<Texture> pages(pageImages.size());
+    JobSystem::run_on_main_thread_and_wait([&]{
+        for(size_t i = 0; i < pageImages.size(); i++){
+            pages[i] = LoadTextureFromImage(pageImages[i]);
+        }
+        for(size_t i = 0; i < pendingTextures.size(); i++){
+            bool isInPage = placements[i].isPacked && pages[placements[i].page].id != 0;
+            if(!isInPage && IsImageValid(pendingTextures[i].image.image)){
+                uploaded[i] = LoadTextureFromImage(pendingTextures[i].image.image);
+            }
+        }
+    });
+    for(Image& pageImage : pageImages){
+        UnloadImage(pageImage);
+    }
+    for(size_t page = 0; page < pages.size(); page++){
+        if(pages[page].id != 0){
+            textures.push_back(SpriteLoader::register_texture(("texture_atlas_page_" + std::to_string(page)).c_str(), pages[page]));
+        }
+    }
+    for(size_t i = 0; i < pendingTextures.size(); i++){
+        const TextureAtlas::Placement& placement = placements[i];
+        if(placement.isPacked && pages[placement.page].id != 0){
+            const Image& image = pendingTextures[i].image.image;
+            Rectangle area = {(float)placement.x, (float)placement.y, (float)image.width, (float)image.height};
+            SpriteLoader::register_atlas_region(pendingTextures[i].filepath.c_str(), pages[placement.page], area);
+        } else if(uploaded[i].id != 0){
+            textures.push_back(SpriteLoader::register_loaded_texture(pendingTextures[i].filepath.c_str(), uploaded[i]));
+        }
+        AssetFiles::unload_image(pendingTextures[i].image);
+    }
+    for(PendingSound& pending : pendingSounds){
+        if(pending.sound.stream.buffer != nullptr){
+            sounds.push_back(SoundLoader::register_loaded_sound(pending.filepath.c_str(), pending.sound));
+        }
+    }
+    pendingTextures.clear();
+    pendingSounds.clear();
+}
+
+void AssetPrefetcher::release(){
+    // decoded but never uploaded
+    wait_for_decodes(pendingTextures);
+    wait_for_decodes(pendingSounds);
+    for(PendingTexture& pending : pendingTextures){
+        AssetFiles::unload_image(pending.image);
+    }
+    for(PendingSound& pending : pendingSounds){
+        if(pending.sound.stream.buffer != nullptr){
+            UnloadSound(pending.sound);
+        }
+    }
+    pendingTextures.clear();
+    pendingSounds.clear();
+
+    for(Texture texture : textures){
+        SpriteLoader::return_texture(texture);
+    }
+    for(SoundId sound : sounds){
+        SoundLoader::return_sound(sound);
+    }
+    textures.clear();
+    sounds.clear();
+    requestedFiles.clear();
+    unpackableFiles.clear();
+}
@@ -34,6 +34,19 @@ void move_position(Position& pos, const Velocity& vel, float delta){
     pos.y += vel.v_y * delta;
 }
 
+// The batched functions treat arrays of these components as flat arrays of floats
+static_assert(sizeof(Position) == 2 * sizeof(float) && sizeof(Velocity) == 2 * sizeof(float),
+              "Position and Velocity must be tightly packed pairs of floats");
+
+void move_positions(Position* positions, const Velocity* velocities, size_t count, float delta){
+    util::add_scaled(
+        reinterpret_cast<float*>(positions),
+        reinterpret_cast<const float*>(velocities),
+        delta,
+        2 * count
+    );
+}
+
 void move_position(Position& pos, Velocity& vel, const Acceleration& acc, float delta){
     vel.v_x += acc.a_x * delta;
     vel.v_y += acc.a_y * delta;
@@ -42,9 +55,13 @@ void move_position(Position& pos, Velocity& vel, const Acceleration& acc, float
 }
 
 SpriteSheet::SpriteSheet(const char *filename, unsigned int frameWidth, unsigned int frameHeight): 
-texture(SpriteLoader::load_or_get_texture(filename)), 
-numberFramesPerRow(texture.width / frameWidth), 
-numberRows(texture.height / frameHeight), 
+SpriteSheet(SpriteLoader::load_or_get_texture_region(filename), frameWidth, frameHeight) {}
+
+SpriteSheet::SpriteSheet(const SpriteLoader::TextureRegion& region, unsigned int frameWidth, unsigned int frameHeight): 
+texture(region.texture), 
+source(region.source),
+numberFramesPerRow(source.width / frameWidth), 
+numberRows(source.height / frameHeight), 
 numberFramesPerAnimation(numberRows), 
 currentAnimation(0), currentFrame(0) {}
 
@@ -74,13 +91,21 @@ Rectangle transform_frame_rect(const Rectangle& source, const SpriteTransform& t
     };
 }
 
+void get_sprite_draw_rects(const SpriteSheet& sprite, const SpriteTransform& transform, const Position& pos,
+                           Rectangle& source, Rectangle& dest, Vector2& origin){
+    int frameWidth = sprite.source.width / sprite.numberFramesPerRow;
+    int frameHeight = sprite.source.height / sprite.numberRows;
+    source = {sprite.source.x + frameWidth * sprite.currentFrame, sprite.source.y + frameHeight * sprite.currentAnimation, frameWidth, frameHeight};
+    dest = {pos.x - frameWidth/2.0f, pos.y - frameHeight/2.0f, frameWidth, frameHeight};
+    dest = transform_frame_rect(dest, transform);
+    dest.x += dest.width / 2; dest.y += dest.height / 2;
+    origin = {dest.width / 2, dest.height / 2};
+}
+
 void draw_sprite(const SpriteSheet& sprite, const SpriteTransform& transform, const Position& pos){
-    int frameWidth = sprite.texture.width / sprite.numberFramesPerRow;
-    int frameHeight = sprite.texture.height / sprite.numberRows;
-    Rectangle frame {frameWidth * sprite.currentFrame, frameHeight * sprite.currentAnimation, frameWidth, frameHeight};
-    Rectangle destFrame = {pos.x - frameWidth/2.0f, pos.y - frameHeight/2.0f, frameWidth, frameHeight};
-    destFrame = transform_frame_rect(destFrame, transform);
-    destFrame.x += destFrame.width / 2; destFrame.y += destFrame.height / 2;
-    DrawTexturePro(sprite.texture, frame, destFrame, {destFrame.width / 2, destFrame.height / 2}, transform.rotation, WHITE);
+    Rectangle frame, destFrame;
+    Vector2 origin;
+    get_sprite_draw_rects(sprite, transform, pos, frame, destFrame, origin);
+    DrawTexturePro(sprite.texture, frame, destFrame, origin, transform.rotation, WHITE);
 }
 
@@ -92,8 +92,8 @@ BoundingBoxComponent calculate_bb(const CollisionComponent& collision, float mar
 }
 
 BoundingBoxComponent calculate_bb(const SpriteSheet& sprite, float margin){
-    int frameWidth = sprite.texture.width / sprite.numberFramesPerRow;
-    int frameHeight = sprite.texture.height / sprite.numberRows;
+    int frameWidth = sprite.source.width / sprite.numberFramesPerRow;
+    int frameHeight = sprite.source.height / sprite.numberRows;
     BoundingBoxComponent output {{-frameWidth/2, -frameHeight/2}, 0, 0};
     output.width = frameWidth;
     output.height = frameHeight;
@@ -103,3 +103,62 @@ BoundingBoxComponent calculate_bb(const SpriteSheet& sprite, float margin){
     }
     return output;
 }
+
+
+void recalculate_bounding_box(entt::registry& registry, entt::entity entity){
+    BoundingBoxComponent bb = BB_ZERO;
+    const CollisionComponent* collision = registry.try_get<CollisionComponent>(entity);
+    if(collision != nullptr){
+        bb = calculate_bb(*collision);
+    } else {
+        const SpriteSheet* sprite = registry.try_get<SpriteSheet>(entity);
+        if(sprite != nullptr){
+            bb = calculate_bb(*sprite);
+        }
+    }
+    registry.emplace_or_replace<BoundingBoxComponent>(entity, bb);
+}
+
+void refresh_world_aabb(entt::registry& registry, entt::entity entity){
+    const Position* pos = registry.try_get<Position>(entity);
+    const BoundingBoxComponent* bb = registry.try_get<BoundingBoxComponent>(entity);
+    if(pos != nullptr && bb != nullptr){
+        registry.emplace_or_replace<WorldAABB>(entity, to_world_aabb(*bb, *pos));
+    } else {
+        registry.remove<WorldAABB>(entity);
+    }
+}
+
+static void remove_world_aabb(entt::registry& registry, entt::entity entity){
+    registry.remove<WorldAABB>(entity);
+}
+
+void track_world_aabbs(entt::registry& registry){
+    registry.on_construct<Position>().connect<&refresh_world_aabb>();
+    registry.on_update<Position>().connect<&refresh_world_aabb>();
+    registry.on_destroy<Position>().connect<&remove_world_aabb>();
+    registry.on_construct<BoundingBoxComponent>().connect<&refresh_world_aabb>();
+    registry.on_update<BoundingBoxComponent>().connect<&refresh_world_aabb>();
+    registry.on_destroy<BoundingBoxComponent>().connect<&remove_world_aabb>();
+    // these aren't connected on construction, since collisions and sprites are usually emplaced
+    // empty and filled in afterwards (and the level file gives the bounding box explicitly anyway)
+    registry.on_update<CollisionComponent>().connect<&recalculate_bounding_box>();
+    registry.on_update<SpriteSheet>().connect<&recalculate_bounding_box>();
+}
+
+void refresh_moving_world_aabbs(entt::registry& registry){
+    auto movingEntities = registry.view<WorldAABB, const BoundingBoxComponent, const Position, const Velocity>();
+    for(auto[entity, aabb, bb, pos, vel] : movingEntities.each()){
+        // bodies at rest didn't move, so their boxes are still right
+        if(vel.v_x != 0 || vel.v_y != 0){
+            aabb = to_world_aabb(bb, pos);
+        }
+    }
+}
+
+void refresh_all_world_aabbs(entt::registry& registry){
+    auto entities = registry.view<WorldAABB, const BoundingBoxComponent, const Position>();
+    for(auto[entity, aabb, bb, pos] : entities.each()){
+        aabb = to_world_aabb(bb, pos);
+    }
+}
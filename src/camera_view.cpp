@@ -1,4 +1,5 @@
 #include "camera_view.h"
+#include <algorithm>
 
 CameraView camera_centered_at(const Position& pos){
     static const float DEFAULT_CAMERA_ZOOM = 1.0;
@@ -31,8 +32,21 @@ void zoom_camera(CameraView& camera, float zoomFactor, bool zoomMode){
 BoundingBoxComponent get_camera_bb(const CameraView& camera, bool includeMargin){
     static const Vector2 MARGIN = {10, 10};
 
-    Vector2 topLeft = GetScreenToWorld2D(VEC2_ZERO, camera.cam);
-    Vector2 bottomRight = GetScreenToWorld2D({GetScreenWidth(), GetScreenHeight()}, camera.cam);
+    float screenWidth = GetScreenWidth();
+    float screenHeight = GetScreenHeight();
+    // all four corners are needed, since with rotation any of them can end up being the leftmost, topmost,...
+    Vector2 corners[4] = {
+        GetScreenToWorld2D(VEC2_ZERO, camera.cam),
+        GetScreenToWorld2D({screenWidth, 0}, camera.cam),
+        GetScreenToWorld2D({0, screenHeight}, camera.cam),
+        GetScreenToWorld2D({screenWidth, screenHeight}, camera.cam)
+    };
+    Vector2 topLeft = corners[0];
+    Vector2 bottomRight = corners[0];
+    for(const Vector2& corner : corners){
+        topLeft = {std::min(topLeft.x, corner.x), std::min(topLeft.y, corner.y)};
+        bottomRight = {std::max(bottomRight.x, corner.x), std::max(bottomRight.y, corner.y)};
+    }
     if(includeMargin){
         topLeft -= MARGIN;
         bottomRight += MARGIN;
@@ -47,3 +61,8 @@ BoundingBoxComponent get_camera_bb(const CameraView& camera, bool includeMargin)
 bool is_in_view(const CameraView& camera, const BoundingBoxComponent& bb, const Position& pos){
     return overlapping_bb(bb, get_camera_bb(camera), pos);
 }
+
+
+WorldAABB get_camera_aabb(const CameraView& camera, bool includeMargin){
+    return to_world_aabb(get_camera_bb(camera, includeMargin), Position{0,0});
+}
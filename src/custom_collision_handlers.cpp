@@ -2,6 +2,7 @@
 #include "collision_handler.h"
 #include "collision_shapes.h"
 #include "sound_component.h"
+#include "basic_components.h"
 
 PlaySoundCollisionHandler::PlaySoundCollisionHandler(SoundKey playedSoundKey) : playedSoundKey(playedSoundKey) {};
 
@@ -9,6 +10,11 @@ void PlaySoundCollisionHandler::operator() (CollisionInformation info, bool phys
     if(!info.collision) return;
     SoundComponent* soundComponent = registry.try_get<SoundComponent>(entityThis);
     if(soundComponent != nullptr){
-        try_play_sound(*soundComponent, this->playedSoundKey);
+        const Position* position = registry.try_get<Position>(entityThis);
+        if(position != nullptr){
+            try_play_sound(*soundComponent, this->playedSoundKey, to_Vector2(*position));
+        } else {
+            try_play_sound(*soundComponent, this->playedSoundKey);
+        }
     }
 }
\ No newline at end of file
@@ -0,0 +1,18 @@
+#include"frame_snapshot.h"
+
+void draw_frame_snapshot(FrameSnapshot& frame, bool debugMode){
+    static const Color BACKGROUND_COLOR = DARKGRAY;
+
+    BeginDrawing();
+        BeginMode2D(frame.camera);
+            ClearBackground(BACKGROUND_COLOR);
+            frame.queue.submit();
+            draw_player_drag_velocity(frame.player, frame.playerPos);
+        EndMode2D();
+        DrawFPS(10,10);
+        if(debugMode){
+            const RenderStats& stats = frame.queue.get_stats();
+            DrawText(TextFormat("%zu draw commands, %zu texture binds", stats.commands, stats.textureBinds), 10, 30, 20, LIME);
+        }
+    EndDrawing();
+}
@@ -0,0 +1,380 @@
+#include"job_system.h"
+#include"utility/arena.h"
+#include<algorithm>
+#include<condition_variable>
+#include<deque>
+#include<thread>
+
+using JobSystem::Task;
+using JobSystem::TaskHandle;
+
+namespace {
+
+// Each worker owns one of these. The owner pushes and pops at the back (so it keeps working on
+// the most recent, cache-hot tasks) while other workers steal from the front.
+struct WorkerQueue {
+    std::mutex mutex;
+    std::deque<TaskHandle> tasks;
+};
+
+std::vector<std::unique_ptr<WorkerQueue>> _workerQueues;
+std::vector<std::thread> _workers;
+std::deque<TaskHandle> _mainThreadQueue;
+std::mutex _mainThreadQueueMutex;
+// Long tasks (see JobSystem::run_in_background), only taken by idle workers
+std::deque<TaskHandle> _backgroundQueue;
+std::mutex _backgroundQueueMutex;
+
+// Workers with nothing to do sleep on this until a task gets queued
+std::mutex _sleepMutex;
+std::condition_variable _wakeCondition;
+std::atomic<size_t> _numberQueuedTasks{0};
+std::atomic<size_t> _nextQueue{0};
+std::atomic<size_t> _numberRunningWorkers{0};
+bool _stopping = false;
+
+std::mutex _initMutex;
+std::atomic<bool> _running{false};
+std::thread::id _mainThreadId;
+std::atomic<bool> _mainThreadRegistered{false};
+thread_local size_t _workerIndex = JobSystem::NOT_A_WORKER;
+
+void ensure_started(){
+    if(!_running.load(std::memory_order_acquire)){
+        JobSystem::init();
+    }
+}
+
+void push_task(const TaskHandle& task){
+    if(task->mainThreadOnly){
+        std::lock_guard<std::mutex> lock(_mainThreadQueueMutex);
+        _mainThreadQueue.push_back(task);
+        return;
+    }
+    if(task->background){
+        std::lock_guard<std::mutex> lock(_backgroundQueueMutex);
+        _backgroundQueue.push_back(task);
+    } else {
+        size_t queueIdx = _workerIndex;
+        if(queueIdx == JobSystem::NOT_A_WORKER){
+            queueIdx = _nextQueue.fetch_add(1, std::memory_order_relaxed) % _workerQueues.size();
+        }
+        std::lock_guard<std::mutex> lock(_workerQueues[queueIdx]->mutex);
+        _workerQueues[queueIdx]->tasks.push_back(task);
+    }
+    _numberQueuedTasks.fetch_add(1, std::memory_order_release);
+    { std::lock_guard<std::mutex> lock(_sleepMutex); }
+    _wakeCondition.notify_one();
+}
+
+// Pops a task from the given worker's own queue, or steals one from another worker if it's empty.
+// Non-worker threads only steal.
+TaskHandle try_pop_task(size_t workerIdx){
+    const size_t numberQueues = _workerQueues.size();
+    if(workerIdx != JobSystem::NOT_A_WORKER){
+        WorkerQueue& ownQueue = *_workerQueues[workerIdx];
+        std::lock_guard<std::mutex> lock(ownQueue.mutex);
+        if(!ownQueue.tasks.empty()){
+            TaskHandle task = std::move(ownQueue.tasks.back());
+            ownQueue.tasks.pop_back();
+            _numberQueuedTasks.fetch_sub(1, std::memory_order_relaxed);
+            return task;
+        }
+    }
+    size_t start = (workerIdx == JobSystem::NOT_A_WORKER) ? 0 : workerIdx + 1;
+    for(size_t i = 0; i < numberQueues; i++){
+        WorkerQueue& victim = *_workerQueues[(start + i) % numberQueues];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if(!victim.tasks.empty()){
+            TaskHandle task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            _numberQueuedTasks.fetch_sub(1, std::memory_order_relaxed);
+            return task;
+        }
+    }
+    return nullptr;
+}
+
+// Pops the oldest background task, or the given one only if it's not null.
+TaskHandle try_pop_background_task(const TaskHandle& wanted = nullptr){
+    std::lock_guard<std::mutex> lock(_backgroundQueueMutex);
+    auto iter = wanted ? std::find(_backgroundQueue.begin(), _backgroundQueue.end(), wanted) : _backgroundQueue.begin();
+    if(iter == _backgroundQueue.end()){
+        return nullptr;
+    }
+    TaskHandle task = std::move(*iter);
+    _backgroundQueue.erase(iter);
+    _numberQueuedTasks.fetch_sub(1, std::memory_order_relaxed);
+    return task;
+}
+
+TaskHandle try_pop_main_thread_task(){
+    std::lock_guard<std::mutex> lock(_mainThreadQueueMutex);
+    if(_mainThreadQueue.empty()){
+        return nullptr;
+    }
+    TaskHandle task = std::move(_mainThreadQueue.front());
+    _mainThreadQueue.pop_front();
+    return task;
+}
+
+void release_dependency(const TaskHandle& task){
+    if(task->pendingDependencies.fetch_sub(1, std::memory_order_acq_rel) == 1){
+        push_task(task);
+    }
+}
+
+void execute(const TaskHandle& task){
+    // a thread waiting on a task runs other tasks in the meantime, which must not allocate from
+    // whichever arena that thread was using (see util::ArenaScope)
+    std::pmr::memory_resource* previousArena = util::_currentArena;
+    util::_currentArena = nullptr;
+    try {
+        task->function();
+    } catch(...) {
+        task->exception = std::current_exception();
+    }
+    util::_currentArena = previousArena;
+    // free whatever the function captured as soon as possible
+    task->function = nullptr;
+    std::vector<TaskHandle> continuations;
+    {
+        std::lock_guard<std::mutex> lock(task->mutex);
+        task->done.store(true, std::memory_order_release);
+        continuations.swap(task->continuations);
+    }
+    for(const TaskHandle& continuation : continuations){
+        release_dependency(continuation);
+    }
+}
+
+// Runs one pending task, if there is any the calling thread can run, other than background ones.
+// Returns whether it ran one.
+bool run_one_task(){
+    if(JobSystem::is_main_thread()){
+        if(TaskHandle task = try_pop_main_thread_task()){
+            execute(task);
+            return true;
+        }
+    }
+    if(TaskHandle task = try_pop_task(_workerIndex)){
+        execute(task);
+        return true;
+    }
+    return false;
+}
+
+void worker_loop(size_t workerIdx){
+    _workerIndex = workerIdx;
+    while(true){
+        // background tasks come last, so that short tasks never queue up behind a long one
+        if(TaskHandle task = try_pop_task(workerIdx)){
+            execute(task);
+            continue;
+        }
+        if(TaskHandle task = try_pop_background_task()){
+            execute(task);
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(_sleepMutex);
+        _wakeCondition.wait(lock, []{ return _stopping || _numberQueuedTasks.load(std::memory_order_acquire) > 0; });
+        if(_stopping && _numberQueuedTasks.load(std::memory_order_acquire) == 0){
+            _numberRunningWorkers.fetch_sub(1, std::memory_order_release);
+            return;
+        }
+    }
+}
+
+void wait_without_rethrowing(const TaskHandle& task){
+    // a background task nobody has started is run right away, since there's nothing else to wait for
+    if(task->background){
+        if(TaskHandle queued = try_pop_background_task(task)){
+            execute(queued);
+        }
+    }
+    while(!JobSystem::is_done(task)){
+        if(!run_one_task()){
+            std::this_thread::yield();
+        }
+    }
+}
+
+}
+
+void JobSystem::init(size_t numberWorkers){
+    std::lock_guard<std::mutex> lock(_initMutex);
+    if(_running.load(std::memory_order_relaxed)){
+        return;
+    }
+    if(numberWorkers == 0){
+        size_t hardwareThreads = std::thread::hardware_concurrency();
+        numberWorkers = (hardwareThreads > 1) ? hardwareThreads - 1 : 1;
+    }
+    if(!_mainThreadRegistered.load(std::memory_order_relaxed)){
+        _mainThreadId = std::this_thread::get_id();
+        _mainThreadRegistered.store(true, std::memory_order_release);
+    }
+    _stopping = false;
+    _workerQueues.clear();
+    for(size_t i = 0; i < numberWorkers; i++){
+        _workerQueues.push_back(std::make_unique<WorkerQueue>());
+    }
+    _workers.reserve(numberWorkers);
+    _numberRunningWorkers.store(numberWorkers, std::memory_order_relaxed);
+    for(size_t i = 0; i < numberWorkers; i++){
+        _workers.emplace_back(worker_loop, i);
+    }
+    _running.store(true, std::memory_order_release);
+}
+
+void JobSystem::shutdown(){
+    std::lock_guard<std::mutex> initLock(_initMutex);
+    if(!_running.load(std::memory_order_relaxed)){
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(_sleepMutex);
+        _stopping = true;
+    }
+    _wakeCondition.notify_all();
+    // the workers' remaining jobs may be waiting for main-thread jobs, so keep running those
+    // until they're all done
+    while(_numberRunningWorkers.load(std::memory_order_acquire) > 0){
+        process_main_thread_jobs();
+        std::this_thread::yield();
+    }
+    process_main_thread_jobs();
+    for(std::thread& worker : _workers){
+        worker.join();
+    }
+    _workers.clear();
+    _workerQueues.clear();
+    _running.store(false, std::memory_order_release);
+}
+
+size_t JobSystem::number_of_workers(){
+    ensure_started();
+    return _workers.size();
+}
+
+size_t JobSystem::current_worker_index(){
+    return _workerIndex;
+}
+
+bool JobSystem::is_main_thread(){
+    // the main thread stays registered after shutdown, so this doesn't start the workers back up
+    if(!_mainThreadRegistered.load(std::memory_order_acquire)){
+        ensure_started();
+    }
+    return std::this_thread::get_id() == _mainThreadId;
+}
+
+TaskHandle JobSystem::create_task(JobFunction function, bool mainThreadOnly){
+    ensure_started();
+    TaskHandle task = std::make_shared<Task>();
+    task->function = std::move(function);
+    task->mainThreadOnly = mainThreadOnly;
+    return task;
+}
+
+void JobSystem::add_dependency(const TaskHandle& task, const TaskHandle& prerequisite){
+    task->pendingDependencies.fetch_add(1, std::memory_order_relaxed);
+    std::unique_lock<std::mutex> lock(prerequisite->mutex);
+    if(prerequisite->done.load(std::memory_order_acquire)){
+        lock.unlock();
+        // can't reach zero here, since the task hasn't been submitted yet
+        task->pendingDependencies.fetch_sub(1, std::memory_order_relaxed);
+    } else {
+        prerequisite->continuations.push_back(task);
+    }
+}
+
+void JobSystem::submit(const TaskHandle& task){
+    release_dependency(task);
+}
+
+TaskHandle JobSystem::run(JobFunction function){
+    TaskHandle task = create_task(std::move(function));
+    submit(task);
+    return task;
+}
+
+TaskHandle JobSystem::run_in_background(JobFunction function){
+    TaskHandle task = create_task(std::move(function));
+    task->background = true;
+    submit(task);
+    return task;
+}
+
+TaskHandle JobSystem::then(const TaskHandle& before, JobFunction function, bool mainThreadOnly){
+    TaskHandle task = create_task(std::move(function), mainThreadOnly);
+    add_dependency(task, before);
+    submit(task);
+    return task;
+}
+
+void JobSystem::wait(const TaskHandle& task){
+    wait_without_rethrowing(task);
+    if(task->exception){
+        std::rethrow_exception(task->exception);
+    }
+}
+
+void JobSystem::wait_all(const std::vector<TaskHandle>& tasks){
+    for(const TaskHandle& task : tasks){
+        wait_without_rethrowing(task);
+    }
+    for(const TaskHandle& task : tasks){
+        if(task->exception){
+            std::rethrow_exception(task->exception);
+        }
+    }
+}
+
+void JobSystem::parallel_for(size_t begin, size_t end, size_t grainSize, const std::function<void(size_t, size_t)>& function){
+    if(end <= begin){
+        return;
+    }
+    grainSize = std::max<size_t>(grainSize, 1);
+    const size_t numberChunks = (end - begin + grainSize - 1) / grainSize;
+    if(numberChunks == 1){
+        function(begin, end);
+        return;
+    }
+    // the first chunk is run by the calling thread, the rest are left for whoever grabs them
+    std::vector<TaskHandle> chunkTasks;
+    chunkTasks.reserve(numberChunks - 1);
+    for(size_t chunk = 1; chunk < numberChunks; chunk++){
+        size_t chunkBegin = begin + chunk * grainSize;
+        size_t chunkEnd = std::min(chunkBegin + grainSize, end);
+        chunkTasks.push_back(run([&function, chunkBegin, chunkEnd]{ function(chunkBegin, chunkEnd); }));
+    }
+    std::exception_ptr exception;
+    try {
+        function(begin, std::min(begin + grainSize, end));
+    } catch(...) {
+        exception = std::current_exception();
+    }
+    // the chunks reference `function`, so they must all finish before returning, even on failure
+    for(const TaskHandle& task : chunkTasks){
+        wait_without_rethrowing(task);
+    }
+    if(exception){
+        std::rethrow_exception(exception);
+    }
+    wait_all(chunkTasks);
+}
+
+void JobSystem::process_main_thread_jobs(){
+    if(!is_main_thread()){
+        return;
+    }
+    std::deque<TaskHandle> tasks;
+    {
+        std::lock_guard<std::mutex> lock(_mainThreadQueueMutex);
+        tasks.swap(_mainThreadQueue);
+    }
+    for(const TaskHandle& task : tasks){
+        execute(task);
+    }
+}
@@ -1,4 +1,6 @@
 #include"level_builder.h"
+#include "asset_files.h"
+#include "asset_prefetcher.h"
 #include "basic_components.h"
 #include "collision_component.h"
 #include "sound_component.h"
@@ -48,11 +50,11 @@ namespace LevelBuilder
 {
 using Json = nlohmann::json;
 Context init_level_parsing(const char* jsonFilename){
-    std::ifstream file{jsonFilename};
-    if(file.bad()){
+    // read through AssetFiles, so that levels packed in the asset archive are found there
+    std::string file;
+    if(!AssetFiles::load_file(jsonFilename, file)){
         std::cerr << "<ERROR> at init_level_parsing: failed to open file " << jsonFilename << '\n';
         return Context {
-            .jsonFile = std::move(file),
             .entityNames = {},
             .tilesets = {},
             .error = {ErrorType::COULDNT_OPEN_FILE, std::string(jsonFilename)},
@@ -65,7 +67,6 @@ Context init_level_parsing(const char* jsonFilename){
     } catch(Json::parse_error& err){
         std::cerr << "<ERROR> at init level_parsing: parse error in file " << jsonFilename << ": " << err.what() << '\n';
         return Context {
-            .jsonFile = std::move(file),
             .entityNames = {},
             .tilesets = {},
             .error = {ErrorType::PARSE_ERROR, err.what()},
@@ -73,7 +74,6 @@ Context init_level_parsing(const char* jsonFilename){
         };
     }
     return Context {
-        .jsonFile = std::move(file),
         .entityNames = {},
         .tilesets = {},
         .error = {ErrorType::SUCCESS},
@@ -129,6 +129,18 @@ static std::string json_get_string(Context& context, const Json& object){
     return object.get<std::string>();
 }
 
+static bool json_get_bool(Context& context, const Json& object){
+    if(!object.is_boolean()){
+        THROW_ERROR_RETURN(
+            ErrorType::INVALID_JSON_TYPE,
+            "expected boolean, received '" + to_string(object) + '\'',
+            json_get_bool,
+            false
+        );
+    }
+    return object.get<bool>();
+}
+
 static Color json_get_color(Context& context, const Json& object){
     static const Color ERROR_COLOR = Color{0,0,0,0};
     std::string str;
@@ -413,6 +425,24 @@ static void init_level_data(Context& context, LevelRegistry& registry, const Jso
         );
     }
 
+    if(levelDict.contains("particle_budget")){
+        size_t particleBudget;
+        CHECK_ERROR(
+            particleBudget = json_get_pos_int(context, levelDict.at("particle_budget"));,
+            init_level_data (getting `particle_budget`)
+        );
+        registry.set_particle_budget(particleBudget);
+    }
+
+    if(levelDict.contains("seed")){
+        size_t seed;
+        CHECK_ERROR(
+            seed = json_get_pos_int(context, levelDict.at("seed"));,
+            init_level_data (getting `seed`)
+        );
+        registry.set_seed(seed);
+    }
+
     // TODO: do something with level name
     if(isCameraAtPlayer){
         registry.init_level(Position{playerPos}, Position{goalPos});
@@ -503,6 +533,20 @@ static void load_particle_settings_from_json(Context& context, const Json& parti
             load_particle_settings_from_json
         );
     }
+    bool particleFadeOut = false;
+    if(particleSettingsDict.contains("fade_out")){
+        CHECK_ERROR(
+            particleFadeOut = json_get_bool(context, particleSettingsDict.at("fade_out")), 
+            load_particle_settings_from_json
+        );
+    }
+    unsigned int particlePriority = 0;
+    if(particleSettingsDict.contains("priority")){
+        CHECK_ERROR(
+            particlePriority = json_get_pos_int(context, particleSettingsDict.at("priority")), 
+            load_particle_settings_from_json
+        );
+    }
     outParticleSettings = ParticleSettings {
         .texture = particleTexture,
         .spawningArea = spawningArea,
@@ -513,7 +557,9 @@ static void load_particle_settings_from_json(Context& context, const Json& parti
         .spawnQuantity = particleSpawnQuantity,
         .initialRotation = particleInitialRotation,
         .rotationalVelocity = particleRotationalVelocity,
-        .color = particleColorRange
+        .color = particleColorRange,
+        .priority = particlePriority,
+        .fadeOut = particleFadeOut
     };
 }
 
@@ -538,7 +584,9 @@ static void load_particle_component(Context& context, LevelRegistry& registry, c
         load_particle_settings_from_json(context, settingsDict, particleSettings);, 
         load_particle_component
     );
-    registry.add_component<ParticleGenerator>(entityID, new_particle_generator(std::move(particleSettings)));
+    // every generator gets its own random stream, split from the level's, so that they can be updated in parallel
+    RNGComponent rng = rng_split(*registry.get_component<RNGComponent>(registry.get_rng_entity()));
+    registry.add_component<ParticleGenerator>(entityID, new_particle_generator(std::move(particleSettings), rng));
 }
 
 static void load_sound_component(Context& context, LevelRegistry& registry, const Json& componentObj, entt::entity entityID){
@@ -567,6 +615,12 @@ static void load_sound_component(Context& context, LevelRegistry& registry, cons
         );
         add_sound_to_component(sound, soundFilename.c_str(), to_key(soundKey));
     }
+    if(componentObj.contains("priority")){
+        CHECK_ERROR(
+            sound.priority = json_get_int(context, componentObj.at("priority"));,
+            load_sound_component
+        );
+    }
 }
 
 static void load_bounding_box_component_auto(Context& context, LevelRegistry& registry, entt::entity entityID){
@@ -668,8 +722,8 @@ static void load_sprite_transform_component(Context& context, LevelRegistry& reg
             std::tie(targetWidth, targetHeight) = json_get_width_and_height(context, componentObj);,
             load_sprite_transform_component (note: presence of field `fit_to_width_and_height` requires a corresponding `width` and `height` field)
         );
-        float spriteWidth = sprite->texture.width / sprite->numberFramesPerRow;
-        float spriteHeight = sprite->texture.height / sprite->numberRows;
+        float spriteWidth = sprite->source.width / sprite->numberFramesPerRow;
+        float spriteHeight = sprite->source.height / sprite->numberRows;
         scale = Vector2 {targetWidth / spriteWidth, targetHeight / spriteHeight};
     } else if(componentObj.contains("scale")){
         CHECK_ERROR(
@@ -1191,6 +1245,7 @@ static void load_entity_tilemap_settings(Context& context, LevelRegistry& regist
         load_tilemap_array(context, entityObj.at("tilegrid"), tilemap);,
         load_entity_tilemap_settings
     );
+    tileset_mark_all_dirty(tilemap); // the tilegrid was written straight into the map
     tileset_get_complete_collision(tilemap, collision);
 }
 
@@ -1382,6 +1437,48 @@ static void load_level_tilesets(Context& context, const Json& levelDict){
     }
 }
 
+// Starts loading every asset referenced anywhere in the given JSON value: the files under every `texture`
+// key, and every file in a `sounds` dictionary. Only the textures of SpriteSheet components and tileset
+// tiles are loaded as atlas regions, since nothing else loads its texture through
+// SpriteLoader::load_or_get_texture_region (particles, for one, are drawn with their whole texture).
+static void prefetch_level_assets(const Json& json, AssetPrefetcher& prefetcher){
+    if(json.is_object()){
+        bool isSpriteSheet = json.contains("type") && json.at("type") == "SpriteSheet";
+        for(const auto& [key, value] : json.items()){
+            if(key == "texture" && value.is_string()){
+                if(isSpriteSheet){
+                    prefetcher.prefetch_texture_region(value.get<std::string>());
+                } else {
+                    prefetcher.prefetch_texture(value.get<std::string>());
+                }
+            } else if(key == "sounds" && value.is_object()){
+                for(const auto& [soundKey, soundFilename] : value.items()){
+                    if(soundFilename.is_string()){
+                        prefetcher.prefetch_sound(soundFilename.get<std::string>());
+                    }
+                }
+            } else if(key == "tilesets" && value.is_object()){
+                for(const auto& [tilesetName, tiles] : value.items()){
+                    if(!tiles.is_array()){
+                        continue;
+                    }
+                    for(const Json& tile : tiles){
+                        if(tile.is_object() && tile.contains("texture") && tile.at("texture").is_string()){
+                            prefetcher.prefetch_texture_region(tile.at("texture").get<std::string>());
+                        }
+                    }
+                }
+            } else {
+                prefetch_level_assets(value, prefetcher);
+            }
+        }
+    } else if(json.is_array()){
+        for(const Json& value : json){
+            prefetch_level_assets(value, prefetcher);
+        }
+    }
+}
+
 static void iterate_level_keys(Context& context, LevelRegistry& registry, const Json& levelDict){
     CHECK_ERROR(
         init_level_data(context, registry, levelDict);,
@@ -1398,6 +1495,8 @@ static void iterate_level_keys(Context& context, LevelRegistry& registry, const
 }
 
 void build_level(Context& context, LevelRegistry& registry){
+    // everything created for the level gets allocated from the level's arena
+    util::ArenaScope arenaScope{registry.get_arena()};
     Json levelObject = context.topLevelJsonObject;
     if(!levelObject.is_object()){
         THROW_ERROR(
@@ -1406,10 +1505,20 @@ void build_level(Context& context, LevelRegistry& registry){
             build_level
         );
     }
+    // every asset is decoded in parallel before anything gets built, so that building the level only
+    // finds them already loaded (the prefetcher's references are given back when it's destroyed)
+    AssetPrefetcher prefetcher;
+    prefetcher.prefetch_texture_region(LevelRegistry::PLAYER_SPRITE_FILENAME);
+    prefetcher.prefetch_texture_region(LevelRegistry::GOAL_SPRITE_FILENAME);
+    prefetcher.prefetch_sound(LevelRegistry::PLAYER_HIT_SOUND_FILENAME);
+    prefetch_level_assets(levelObject, prefetcher);
+    prefetcher.upload();
     CHECK_ERROR(
         iterate_level_keys(context, registry, levelObject);,
         build_level
     );
+    prefetcher.release();
+    registry.save_reset_state();
 }
 
 } // namespace LevelBuilder
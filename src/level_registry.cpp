@@ -3,7 +3,12 @@
 #include "collision_component.h"
 #include "collision_handler.h"
 #include "custom_collision_handlers.h"
+#include "job_system.h"
 #include "sound_component.h"
+#include "voice_pool.h"
+#include <algorithm>
+#include <new>
+#include <stdexcept>
 #include <utility>
 #include <vector>
 
@@ -12,49 +17,129 @@ using std::move;
 
 const LayerType LevelRegistry::PLAYER_COLLISION_LAYER = 1;
 
-LevelRegistry::LevelRegistry(){
+LevelRegistry::LevelRegistry() : names(arena.get_resource()), entityNames(arena.get_resource()), sortedEntityNames(arena.get_resource()) {
     registry = make_unique<entt::registry>();
+    // Owning group so that the positions and velocities of all moving entities are packed
+    // together at the start of their storages, in the same order (see integrate_motion).
+    // NOTE: this means emplacing a Position or Velocity can shuffle those storages, so
+    // don't hold references to them across an emplace.
+    registry->group<Position, Velocity>();
+    track_world_aabbs(*registry);
+    scheduler = make_unique<SystemScheduler>();
+    register_systems();
 }
 
 LevelRegistry::~LevelRegistry(){
-    registry->clear();
+    // the registry is null if the level was moved from
+    if(registry){
+        registry->clear();
+    }
     registry.reset();
 }
 
-LevelRegistry::LevelRegistry(LevelRegistry&& other){
-    this->registry = move(other.registry);
-    this->entityNames = move(other.entityNames);
-    this->numberOfLevelObjects = other.numberOfLevelObjects;
+// The name indices are moved along with the arena their nodes live in, so they're move-constructed
+// (which keeps their allocator) rather than move-assigned (which would copy them into this level's arena).
+LevelRegistry::LevelRegistry(LevelRegistry&& other) :
+    arena(move(other.arena)),
+    names(move(other.names)),
+    registry(move(other.registry)),
+    numberOfLevelObjects(other.numberOfLevelObjects),
+    entityNames(move(other.entityNames)),
+    reservedEntities(other.reservedEntities),
+    sortedEntityNames(move(other.sortedEntityNames)),
+    scheduler(move(other.scheduler)),
+    resetSnapshot(move(other.resetSnapshot)),
+    resetRequested(other.resetRequested),
+    levelComplete(other.levelComplete),
+    renderQueue(move(other.renderQueue)),
+    inputSample(other.inputSample),
+    particleBudget(other.particleBudget),
+    seed(other.seed),
+    particleUpdates(move(other.particleUpdates))
+{}
+
+// Destroys `member` and move-constructs it from `source` in its place. Used for the members that allocate
+// from the level's arena: std::pmr allocators don't propagate on assignment, so move-assigning them would
+// copy `source` into this level's arena instead of taking its nodes (and its arena) along.
+template<class T>
+static void move_reconstruct(T& member, T&& source){
+    member.~T();
+    new(&member) T(move(source));
 }
 
 LevelRegistry& LevelRegistry::operator=(LevelRegistry&& rhs){
-    this->entityNames = move(rhs.entityNames);
-    this->registry = move(rhs.registry);
-    this->numberOfLevelObjects = rhs.numberOfLevelObjects;
+    if(this == &rhs){
+        return *this;
+    }
+    // Everything allocated from this level's arena has to go before the arena itself: first the registry,
+    // then the name indices and the name table (the indices' keys point into it). rhs's arena resource stays
+    // at the same address when the arena is moved (see util::LevelArena), so what comes from rhs stays valid.
+    if(registry){
+        registry->clear();
+    }
+    registry = move(rhs.registry);
+    move_reconstruct(sortedEntityNames, move(rhs.sortedEntityNames));
+    move_reconstruct(entityNames, move(rhs.entityNames));
+    move_reconstruct(names, move(rhs.names));
+    arena = move(rhs.arena);
+    numberOfLevelObjects = rhs.numberOfLevelObjects;
+    reservedEntities = rhs.reservedEntities;
+    scheduler = move(rhs.scheduler);
+    resetSnapshot = move(rhs.resetSnapshot);
+    resetRequested = rhs.resetRequested;
+    levelComplete = rhs.levelComplete;
+    renderQueue = move(rhs.renderQueue);
+    inputSample = rhs.inputSample;
+    particleBudget = rhs.particleBudget;
+    seed = rhs.seed;
+    particleUpdates = move(rhs.particleUpdates);
     return *this;
 }
 
 
-entt::entity LevelRegistry::new_entity(const std::string& name){
-    entt::entity newEntity = registry->create();
-    registry->emplace<EntityName>(newEntity, name);
-    entityNames[name] = newEntity;
-    return newEntity;
+NameHandle LevelRegistry::intern_name(std::string_view name){
+    // names usually aren't reused, but if an entity with this exact name exists, its name is shared
+    entt::entity existing = get_entity(util::hash_string(name.data(), name.size()));
+    if(existing != entt::null && registry->valid(existing)){
+        const EntityName* existingName = registry->try_get<EntityName>(existing);
+        if(existingName != nullptr && names.get(existingName->handle) == name){
+            return existingName->handle;
+        }
+    }
+    return names.add(name);
+}
+
+void LevelRegistry::register_entity_name(entt::entity entity, NameHandle nameHandle){
+    std::string_view name = names.get(nameHandle);
+    auto [itr, inserted] = entityNames.try_emplace(names.get_hash(nameHandle), entity);
+    if(!inserted){
+        entt::entity previous = itr->second;
+        const EntityName* previousName = registry->valid(previous) ? registry->try_get<EntityName>(previous) : nullptr;
+        if(previousName != nullptr && names.get(previousName->handle) != name){
+            throw std::invalid_argument("entity name '" + std::string(name) + "' has the same hash as existing entity name '" + std::string(names.get(previousName->handle)) + '\'');
+        }
+        itr->second = entity;
+    }
+    sortedEntityNames[name] = entity;
 }
 
-entt::entity LevelRegistry::new_entity(std::string&& name){
+entt::entity LevelRegistry::new_entity(NameHandle nameHandle){
     entt::entity newEntity = registry->create();
-    registry->emplace<EntityName>(newEntity, std::move(name));
-    entityNames[name] = newEntity;
+    register_entity_name(newEntity, nameHandle);
+    registry->emplace<EntityName>(newEntity, nameHandle);
     return newEntity;
 }
 
+entt::entity LevelRegistry::new_entity(const std::string& name){
+    return new_entity(intern_name(name));
+}
+
 entt::entity LevelRegistry::new_level_object(const std::string& namePrefix, const Position& pos, bool uniqueName){
     entt::entity newEntity;
     if(uniqueName){
         newEntity = new_entity(namePrefix);
     } else {
-        newEntity = new_entity(namePrefix + std::to_string(numberOfLevelObjects));
+        newEntity = new_entity(names.add_numbered(namePrefix, numberOfLevelObjects));
     }
     numberOfLevelObjects++;
     registry->emplace<Position>(newEntity, pos);
@@ -62,7 +147,11 @@ entt::entity LevelRegistry::new_level_object(const std::string& namePrefix, cons
 }
 
 entt::entity LevelRegistry::get_entity(const std::string& name) const{
-    auto itr = entityNames.find(name);
+    return get_entity(util::hash_string(name));
+}
+
+entt::entity LevelRegistry::get_entity(EntityNameHash nameHash) const{
+    auto itr = entityNames.find(nameHash);
     if(itr != entityNames.end()){
         return itr->second;
     } else {
@@ -70,31 +159,36 @@ entt::entity LevelRegistry::get_entity(const std::string& name) const{
     }
 }
 
-entt::entity LevelRegistry::get_entity(std::string&& name) const{
-    auto itr = entityNames.find(std::move(name));
-    if(itr != entityNames.end()){
-        return itr->second;
-    } else {
-        return entt::null;
+void LevelRegistry::destroy_entity(entt::entity entity){
+    const EntityName* entityName = registry->try_get<EntityName>(entity);
+    if(entityName != nullptr){
+        auto itr = entityNames.find(names.get_hash(entityName->handle));
+        if(itr != entityNames.end() && itr->second == entity){
+            entityNames.erase(itr);
+        }
+        auto sortedItr = sortedEntityNames.find(names.get(entityName->handle));
+        if(sortedItr != sortedEntityNames.end() && sortedItr->second == entity){
+            sortedEntityNames.erase(sortedItr);
+        }
     }
+    registry->destroy(entity);
+}
+
+std::string_view LevelRegistry::get_entity_name(entt::entity entity) const{
+    const EntityName* entityName = registry->try_get<EntityName>(entity);
+    return (entityName != nullptr) ? names.get(entityName->handle) : std::string_view();
 }
 
 std::vector<entt::entity> LevelRegistry::search_entities_by_name(const std::string& prefix) const{
     std::vector<entt::entity> output;
-    output.reserve(registry->view<entt::entity>().size() / 10); // let's say about a tenth of all entities. might change this later
-    for(const auto&[name, entity] : entityNames){
-        auto nameItr = name.begin(); auto pfxItr = prefix.begin();
-        bool matching = true;
-        const auto nameEnd = name.end(); const auto pfxEnd = prefix.end();
-        while(pfxItr != pfxEnd && nameItr != nameEnd && matching){
-            if(*pfxItr != *nameItr){
-                matching = false;
-            }
-            ++nameItr; ++pfxItr;
-        }
-        if(matching){
-            output.push_back(entity);
+    // all names starting with the prefix are contiguous in the ordered index, beginning at
+    // the first name that isn't less than the prefix itself
+    for(auto itr = sortedEntityNames.lower_bound(std::string_view(prefix)); itr != sortedEntityNames.end(); ++itr){
+        std::string_view name = itr->first;
+        if(name.compare(0, prefix.size(), prefix) != 0){
+            break;
         }
+        output.push_back(itr->second);
     }
     return output;
 }
@@ -108,12 +202,11 @@ const entt::registry& LevelRegistry::get() const{
 }
 
 entt::entity LevelRegistry::create_player(const Position& pos){
-    static const char* const BALL_SPRITE_FILENAME = "resources/sprites/ball.png";
     static const float PLAYER_RADIUS = 8;
 
     entt::entity player = new_level_object(PLAYER_ENTITY_NAME, pos, true);
     registry->emplace<Velocity>(player, 0, 0);
-    registry->emplace<SpriteSheet>(player, BALL_SPRITE_FILENAME, 16, 16);
+    registry->emplace<SpriteSheet>(player, PLAYER_SPRITE_FILENAME, 16, 16);
     registry->emplace<SpriteTransform>(player, VEC2_ZERO, 1, 0);
     CollisionComponent& collision = registry->emplace<CollisionComponent>(player, new CollisionCircle(VEC2_ZERO, PLAYER_RADIUS), 0, false);
     add_to_layer(collision, PLAYER_COLLISION_LAYER);
@@ -122,7 +215,8 @@ entt::entity LevelRegistry::create_player(const Position& pos){
     BoundingBoxComponent playerBB = calculate_bb(collision, 0);
     registry->emplace<BoundingBoxComponent>(player, playerBB);
     SoundComponent& playerSoundComponent = registry->emplace<SoundComponent>(player);
-    add_sound_to_component(playerSoundComponent, "resources/sounds/hit_1.ogg", "hit"_sound);
+    add_sound_to_component(playerSoundComponent, PLAYER_HIT_SOUND_FILENAME, "hit"_sound);
+    playerSoundComponent.priority = PLAYER_SOUND_PRIORITY;
     CollisionHandler playerCollisionHandler = CollisionHandler{
         .handler = join_handlers(
             DefaultElasticCollisionHandler{0.9}, 
@@ -132,12 +226,11 @@ entt::entity LevelRegistry::create_player(const Position& pos){
     };
     registry->emplace<CollisionHandler>(player, playerCollisionHandler);
 
+    reservedEntities.player = player;
     return player;
 }
 
 entt::entity LevelRegistry::create_goal(const Position& pos){
-    static const char* const GOAL_SPRITE_FILENAME = "resources/sprites/flag.png";
-
     entt::entity goal = new_level_object(GOAL_ENTITY_NAME, pos, true);
     SpriteSheet& sprite = registry->emplace<SpriteSheet>(goal, GOAL_SPRITE_FILENAME, 16, 32);
     sprite.set_animation_length(0, sprite.numberFramesPerRow);
@@ -147,12 +240,14 @@ entt::entity LevelRegistry::create_goal(const Position& pos){
     BoundingBoxComponent goalBB = calculate_bb(collision, 0);
     registry->emplace<BoundingBoxComponent>(goal, goalBB);
 
+    reservedEntities.goal = goal;
     return goal;
 }
 
 entt::entity LevelRegistry::create_camera_centered_at(const Position& pos){
     entt::entity camera = new_entity(CAMERA_ENTITY_NAME);
     registry->emplace<CameraView>(camera, camera_centered_at(pos));
+    reservedEntities.camera = camera;
     return camera;
 }
 
@@ -163,9 +258,11 @@ void LevelRegistry::init_level(const Position& playerPos, const Position& goalPo
     // TODO later: level info component
     entt::entity input = new_entity(INPUT_MANAGER_ENTITY_NAME);
     registry->emplace<InputManager>(input);
+    reservedEntities.inputManager = input;
 
     entt::entity rng = new_entity(RNG_ENTITY_NAME);
-    registry->emplace<RNGComponent>(rng, new_rng_component());
+    registry->emplace<RNGComponent>(rng, new_rng_component(seed));
+    reservedEntities.rng = rng;
 }
 
 CollisionComponent& LevelRegistry::make_entity_into_static_body(entt::entity entity, const Position& pos, std::vector<LayerType>&& layers){
@@ -195,17 +292,7 @@ std::pair<entt::entity, CollisionComponent&> LevelRegistry::create_static_body(c
 }
 
 void LevelRegistry::recalculate_bounding_box(entt::entity entity){
-    BoundingBoxComponent bb;
-    CollisionComponent* collision = registry->try_get<CollisionComponent>(entity);
-    if(collision != nullptr){
-        bb = calculate_bb(*collision);
-    } else {
-        SpriteSheet* sprite = registry->try_get<SpriteSheet>(entity);
-        if(sprite != nullptr){
-            bb = calculate_bb(*sprite);
-        }
-    }
-    registry->emplace_or_replace<BoundingBoxComponent>(entity, bb);
+    ::recalculate_bounding_box(*registry, entity);
 }
 
 void LevelRegistry::handle_collisions_general(){
@@ -217,12 +304,12 @@ void LevelRegistry::handle_collisions_general(){
         store.collidedEntityID = entt::null;
     }
 
-    auto collisionEntities = registry->view<CollisionComponent, Position, const BoundingBoxComponent>();
-    for(auto[entity_i, collision_i, position_i, bb_i] : collisionEntities.each()){
-        for(auto[entity_j, collision_j, position_j, bb_j] : collisionEntities.each()){
+    auto collisionEntities = registry->view<CollisionComponent, Position, WorldAABB>();
+    for(auto[entity_i, collision_i, position_i, aabb_i] : collisionEntities.each()){
+        for(auto[entity_j, collision_j, position_j, aabb_j] : collisionEntities.each()){
             if(entity_i < entity_j // avoid repeated collisions
              && (!collision_i.isStatic || !collision_j.isStatic) // no need to check if both bodies are static
-             && overlapping_bb(bb_i, bb_j, position_i, position_j)){ // only check if their bounding boxes are colliding
+             && overlapping_aabb(aabb_i, aabb_j)){ // only check if their bounding boxes are colliding
 
                 CollisionInformation info = get_collision(collision_i, collision_j, position_i, position_j);
                 if(info.collision){ // congrats, they're colliding
@@ -236,6 +323,10 @@ void LevelRegistry::handle_collisions_general(){
                     } else { // entity_j isn't static
                         move_object_out_of_collision(collision_j, collision_i, position_j, position_i, info);
                     }
+                    // the positions were written directly, so the cached boxes have to be refreshed by hand
+                    // (the rest of the loop checks against them)
+                    aabb_i = to_world_aabb(registry->get<BoundingBoxComponent>(entity_i), position_i);
+                    aabb_j = to_world_aabb(registry->get<BoundingBoxComponent>(entity_j), position_j);
 
                     // call collision handlers
                     CollisionHandler* handler_i = registry->try_get<CollisionHandler>(entity_i);
@@ -256,7 +347,6 @@ void LevelRegistry::handle_collisions_general(){
                     if(store_j != nullptr){
                         store_j->collidedEntityID = entity_i;
                     }
-                    std::cout << "collision detected! entities: " << (unsigned int)entity_i << ", " << (unsigned int)entity_j << "\n";
                 }
 
             }
@@ -274,101 +364,233 @@ void LevelRegistry::handle_animations(float delta){
     }
 }
 
-void LevelRegistry::handle_camera(float delta){
+void LevelRegistry::handle_particles(float delta){
+    // Maximum number of generators updated by each parallel task
+    static const size_t PARTICLE_GENERATORS_PER_TASK = 4;
+
+    // Particles alive at the start of the frame count against the budget, and what's left of it is
+    // handed out to the generators in order of priority, each one getting as much as it could spawn this
+    // frame. Once it runs out, the remaining generators spawn fewer particles (or none) instead of going
+    // over it. The allowances only depend on the generators' state, so the results are the same no
+    // matter how the updates below get scheduled.
+    // Generators out of view don't spawn anything, so they don't take any of the budget.
+    const WorldAABB cameraAABB = get_camera_aabb(registry->get<CameraView>(reservedEntities.camera));
+    particleUpdates.clear();
+    size_t numberAlive = 0;
+    auto particleGenerators = registry->view<ParticleGenerator, const Position>();
+    for(auto[entity, particles, pos] : particleGenerators.each()){
+        bool visible = overlapping_aabb(particle_generator_bounds(particles, pos), cameraAABB);
+        particleUpdates.push_back(ParticleUpdate{&particles, 0, visible});
+        numberAlive += particles.particlePool.size();
+    }
+    std::stable_sort(particleUpdates.begin(), particleUpdates.end(),
+        [](const ParticleUpdate& a, const ParticleUpdate& b){ return a.generator->settings.priority > b.generator->settings.priority; }
+    );
+    size_t remainingBudget = (numberAlive < particleBudget) ? particleBudget - numberAlive : 0;
+    for(ParticleUpdate& update : particleUpdates){
+        if(update.visible){
+            update.spawnAllowance = std::min(particle_generator_max_spawned(*update.generator, delta), remainingBudget);
+            remainingBudget -= update.spawnAllowance;
+        }
+    }
+
+    // every generator has its own pool and random stream, so they're all independent
+    JobSystem::parallel_for(0, particleUpdates.size(), PARTICLE_GENERATORS_PER_TASK, [this, delta](size_t begin, size_t end){
+        for(size_t i = begin; i < end; i++){
+            const ParticleUpdate& update = particleUpdates[i];
+            if(update.visible){
+                particle_generator_update(*update.generator, delta, update.spawnAllowance);
+            } else {
+                particle_generator_advance_clock(*update.generator, delta);
+            }
+        }
+    });
+}
+
+void LevelRegistry::handle_camera(float /*delta*/){
     // only moves camera to player, for now
     static const float LERP_WEIGHT = 0.25;
 
-    CameraView& camera = registry->get<CameraView>(get_entity(CAMERA_ENTITY_NAME));
-    const Position& playerPos = registry->get<Position>(get_entity(PLAYER_ENTITY_NAME));
+    CameraView& camera = registry->get<CameraView>(reservedEntities.camera);
+    const Position& playerPos = registry->get<Position>(reservedEntities.player);
     Vector2 newCameraPos = camera->target + (to_Vector2(playerPos) - camera->target) * LERP_WEIGHT;
     set_camera_center(camera, Position{newCameraPos});
 }
 
 void LevelRegistry::handle_input_and_player(){
-    InputManager& input = registry->get<InputManager>(get_entity(INPUT_MANAGER_ENTITY_NAME));
-    entt::entity playerID = get_entity(PLAYER_ENTITY_NAME);
+    InputManager& input = registry->get<InputManager>(reservedEntities.inputManager);
+    entt::entity playerID = reservedEntities.player;
     PlayerComponent& player = registry->get<PlayerComponent>(playerID);
     Velocity& vel = registry->get<Velocity>(playerID);
-    const CameraView& camera = registry->get<CameraView>(get_entity(CAMERA_ENTITY_NAME));
+    const CameraView& camera = registry->get<CameraView>(reservedEntities.camera);
 
-    update_input(input);
+    apply_input_sample(input, inputSample);
     update_player(player, vel, input, camera);
     if(is_input_pressed_this_frame(input, InputManager::RESET)){
-        // TODO: implement level resetting
+        resetRequested = true;
     } else if(is_input_pressed_this_frame(input, InputManager::PAUSE)){
         // TODO: also implement pausing. god i have zero idea how to do this
     }
 
     const auto& store = registry->get<CollisionEntityStoreComponent>(playerID);
-    if(store.collidedEntityID == entityNames.at(GOAL_ENTITY_NAME)){
-        //TODO: player won, level ends. don't know where to go, just panic segfault
-        int x = *(int*)nullptr;
-        std::cout << x;
+    if(store.collidedEntityID == reservedEntities.goal){
+        // the level sequence moves on to the next level (see LevelSequence)
+        levelComplete = true;
     }
 }
 
 #include<iostream>
 
+void LevelRegistry::integrate_motion(float delta){
+    // Accelerations are applied first, entity by entity, because only a few entities have them
+    // (and the acceleration storage can't be packed alongside the group below: EnTT doesn't allow
+    // two owning groups sharing Position/Velocity). Doing it beforehand keeps the same semi-implicit
+    // integration as move_position(pos, vel, accel, delta).
+    auto acceleratedEntities = registry->view<Velocity, const Acceleration>();
+    for(auto[entity, vel, accel] : acceleratedEntities.each()){
+        vel.v_x += accel.a_x * delta;
+        vel.v_y += accel.a_y * delta;
+    }
+
+    // Then all positions are moved at once. The group's entities occupy the first group.size()
+    // slots of both storages, but the storages are paged, so the batches go page by page.
+    auto movingEntities = registry->group<Position, Velocity>();
+    const size_t numberMoving = movingEntities.size();
+    Position* const* positionPages = movingEntities.storage<Position>()->raw();
+    Velocity* const* velocityPages = movingEntities.storage<Velocity>()->raw();
+    static constexpr size_t POSITION_PAGE_SIZE = entt::component_traits<Position>::page_size;
+    static constexpr size_t VELOCITY_PAGE_SIZE = entt::component_traits<Velocity>::page_size;
+    static_assert(POSITION_PAGE_SIZE == VELOCITY_PAGE_SIZE, "Position and Velocity storages must have the same page size");
+    for(size_t pageBegin = 0; pageBegin < numberMoving; pageBegin += POSITION_PAGE_SIZE){
+        size_t page = pageBegin / POSITION_PAGE_SIZE;
+        size_t count = std::min(POSITION_PAGE_SIZE, numberMoving - pageBegin);
+        move_positions(positionPages[page], velocityPages[page], count, delta);
+    }
+    // positions were written directly, so no signal refreshed their world boxes
+    refresh_moving_world_aabbs(*registry);
+}
+
+void LevelRegistry::register_systems(){
+    // Systems are added in the order they used to run serially. The scheduler keeps that order
+    // between the ones that conflict (e.g. motion -> collisions -> input), while the others
+    // (animations, particles) run alongside them.
+    scheduler->add_system(*registry, "motion",
+        [](LevelRegistry& level, float delta){ level.integrate_motion(delta); },
+        SystemReads<Acceleration>{},
+        SystemWrites<Position, Velocity, WorldAABB>{}
+    );
+    scheduler->add_system(*registry, "collisions",
+        [](LevelRegistry& level, float /*delta*/){ level.handle_collisions_general(); },
+        SystemReads<CollisionComponent, BoundingBoxComponent>{},
+        SystemWrites<Position, Velocity, WorldAABB, CollisionHandler, CollisionEntityStoreComponent, SoundComponent>{}
+    );
+    scheduler->add_system(*registry, "input_and_player",
+        [](LevelRegistry& level, float /*delta*/){ level.handle_input_and_player(); },
+        SystemReads<CameraView, CollisionEntityStoreComponent>{},
+        SystemWrites<InputManager, PlayerComponent, Velocity>{}
+    );
+    scheduler->add_system(*registry, "animations",
+        [](LevelRegistry& level, float delta){ level.handle_animations(delta); },
+        SystemReads<>{},
+        SystemWrites<AnimationHandler, SpriteSheet>{}
+    );
+    scheduler->add_system(*registry, "particles",
+        [](LevelRegistry& level, float delta){ level.handle_particles(delta); },
+        SystemReads<Position, CameraView>{},
+        SystemWrites<ParticleGenerator>{}
+    );
+    //handle_camera(delta);
+}
+
 void LevelRegistry::update(float delta){
-    //move objects with velocity
     //std::cout << "frame update!\n";
-    auto viewPositionAndVelocity = registry->view<Position, Velocity>();
-    for(auto[entity, pos, vel] : viewPositionAndVelocity.each()){
-        if(registry->all_of<const Acceleration>(entity)){ //const may not be necessary?
-            const Acceleration& accel = registry->get<const Acceleration>(entity);
-            move_position(pos, vel, accel, delta);
-        } else {
-            move_position(pos, vel, delta);
+    // positional sounds are heard from the center of the camera
+    VoicePool::set_listener(registry->get<CameraView>(reservedEntities.camera)->target);
+    scheduler->run(*this, delta);
+    if(resetRequested){
+        restore(resetSnapshot);
+        resetRequested = false;
+    }
+}
+
+void LevelRegistry::snapshot(LevelSnapshot& snapshot) const{
+    take_level_snapshot(*registry, snapshot);
+}
+
+void LevelRegistry::restore(const LevelSnapshot& snapshot){
+    restore_level_snapshot(*registry, snapshot);
+    refresh_all_world_aabbs(*registry);
+}
+
+void LevelRegistry::save_reset_state(){
+    snapshot(resetSnapshot);
+}
+
+void LevelRegistry::bake_visible_tilemaps(const WorldAABB& cameraAABB) const{
+    auto tilemaps = registry->view<const TilesetComponent, const Position, const WorldAABB>();
+    for(auto[entity, tilemap, pos, aabb] : tilemaps.each()){
+        if(overlapping_aabb(aabb, cameraAABB)){
+            tileset_bake_dirty_chunks(tilemap, pos, cameraAABB);
         }
     }
+}
 
-    handle_collisions_general(); // maybe dispatch this to another thread?
-    handle_input_and_player();
-    handle_animations(delta);
-    //handle_camera(delta);
+bool LevelRegistry::has_dirty_visible_tilemaps(const WorldAABB& cameraAABB) const{
+    auto tilemaps = registry->view<const TilesetComponent, const Position, const WorldAABB>();
+    for(auto[entity, tilemap, pos, aabb] : tilemaps.each()){
+        if(overlapping_aabb(aabb, cameraAABB) && tileset_has_dirty_chunks(tilemap, pos, cameraAABB)){
+            return true;
+        }
+    }
+    return false;
+}
 
+void LevelRegistry::queue_draw_commands(RenderQueue& queue, const WorldAABB& cameraAABB) const{
+    // Entities without a bounding box (and therefore without a WorldAABB) aren't drawn
+    auto onlySprites = registry->view<const SpriteSheet, const Position, const WorldAABB>(entt::exclude<SpriteTransform>);
+    for(auto[entity, sprite, pos, aabb] : onlySprites.each()){
+        if(overlapping_aabb(aabb, cameraAABB)){
+            queue.push_sprite(sprite, SpriteTransform(), pos);
+        }
+    }
+    auto transfomedSprites = registry->view<const SpriteSheet, const Position, const SpriteTransform, const WorldAABB>(); // separated into two distinct views for performance reasons
+    for(auto[entity, sprite, pos, transform, aabb] : transfomedSprites.each()){
+        if(overlapping_aabb(aabb, cameraAABB)){
+            queue.push_sprite(sprite, transform, pos);
+        }
+    }
+
+    auto particleGenerators = registry->view<const ParticleGenerator, const Position>();
+    for(auto[entity, particles, pos] : particleGenerators.each()){
+        if(overlapping_aabb(particle_generator_bounds(particles, pos), cameraAABB)){
+            queue.push_particles(particles, pos);
+        }
+    }
+
+    auto tilemaps = registry->view<const TilesetComponent, const Position, const WorldAABB>();
+    for(auto[entity, tilemap, pos, aabb] : tilemaps.each()){
+        if(overlapping_aabb(aabb, cameraAABB)){
+            draw_tileset(tilemap, pos, cameraAABB, queue);
+        }
+    }
 }
 
 void LevelRegistry::draw(bool debugMode) const{
     static const Color BACKGROUND_COLOR = DARKGRAY;
 
+    const CameraView& camera = registry->get<CameraView>(reservedEntities.camera);
+    const WorldAABB cameraAABB = get_camera_aabb(camera);
+    // baking draws into render textures, which can't happen inside BeginMode2D
+    bake_visible_tilemaps(cameraAABB);
+
     BeginDrawing();
-        const CameraView& camera = registry->get<CameraView>(get_entity(CAMERA_ENTITY_NAME));
         BeginMode2D(camera.cam);
             ClearBackground(BACKGROUND_COLOR);
 
-            /*auto spriteEntities = registry->view<const SpriteSheet, const Position>();
-            for(auto[entity, sprite, pos] : spriteEntities.each()){
-
-                const SpriteTransform* transform = registry->try_get<SpriteTransform>(entity);
-                if(transform != nullptr){
-                    draw_sprite(sprite, *transform, pos);
-                } else {
-                    draw_sprite(sprite, pos);
-                }
-            }*/
-            auto onlySprites = registry->view<const SpriteSheet, const Position>(entt::exclude<SpriteTransform>);
-            for(auto[entity, sprite, pos] : onlySprites.each()){
-                const BoundingBoxComponent* bb = registry->try_get<BoundingBoxComponent>(entity);
-                if(bb != nullptr && is_in_view(camera, *bb, pos)){
-                    draw_sprite(sprite, pos);
-                }
-            }
-            auto transfomedSprites = registry->view<const SpriteSheet, const Position, const SpriteTransform>(); // separated into two distinct views for performance reasons
-            for(auto[entity, sprite, pos, transform] : transfomedSprites.each()){
-                const BoundingBoxComponent* bb = registry->try_get<BoundingBoxComponent>(entity);
-                if(bb != nullptr && is_in_view(camera, *bb, pos)){
-                    draw_sprite(sprite, transform, pos);
-                }
-            }
-
-            auto tilemaps = registry->view<const TilesetComponent, const Position>();
-            for(auto[entity, tilemap, pos] : tilemaps.each()){
-                const BoundingBoxComponent* bb = registry->try_get<BoundingBoxComponent>(entity);
-                if(bb != nullptr && is_in_view(camera, *bb, pos)){
-                    draw_tileset(tilemap, pos);
-                }
-            }
+            // everything is queued first and drawn sorted by layer and texture (see RenderQueue)
+            renderQueue.clear();
+            queue_draw_commands(renderQueue, cameraAABB);
+            renderQueue.submit();
 
             if(debugMode){
                 auto collisionEntites = registry->view<const CollisionComponent, const Position>();
@@ -381,12 +603,36 @@ void LevelRegistry::draw(bool debugMode) const{
                     draw_bb_debug(bb, pos);
                 }
             }
-            entt::entity playerEntity = get_entity(PLAYER_ENTITY_NAME);
+            entt::entity playerEntity = reservedEntities.player;
             const PlayerComponent& player = registry->get<PlayerComponent>(playerEntity);
             const Position& pos = registry->get<Position>(playerEntity);
             draw_player_drag_velocity(player, pos);
         EndMode2D();
         DrawFPS(10,10);
+        if(debugMode){
+            const RenderStats& stats = renderQueue.get_stats();
+            DrawText(TextFormat("%zu draw commands, %zu texture binds", stats.commands, stats.textureBinds), 10, 30, 20, LIME);
+        }
         // TODO later: implement and draw UI
     EndDrawing();
 }
+
+void LevelRegistry::write_frame_snapshot(FrameSnapshot& frame) const{
+    const CameraView& camera = registry->get<CameraView>(reservedEntities.camera);
+    const WorldAABB cameraAABB = get_camera_aabb(camera);
+    // the chunks have to be baked before the snapshot is written, so that the snapshot references their
+    // textures instead of falling back to drawing every tile. Baking needs the main thread, so this only
+    // waits for it when a chunk in view actually changed (usually just the first frames of a level).
+    if(has_dirty_visible_tilemaps(cameraAABB)){
+        JobSystem::run_on_main_thread_and_wait([&]{ bake_visible_tilemaps(cameraAABB); });
+    }
+
+    frame.camera = camera.cam;
+    frame.queue.clear();
+    queue_draw_commands(frame.queue, cameraAABB);
+    // sorted here, so that the main thread doesn't have to
+    frame.queue.sort();
+    entt::entity playerEntity = reservedEntities.player;
+    frame.player = registry->get<PlayerComponent>(playerEntity);
+    frame.playerPos = registry->get<Position>(playerEntity);
+}
@@ -0,0 +1,118 @@
+#include"level_sequence.h"
+#include"level_builder.h"
+#include<algorithm>
+#include<iostream>
+#include<stdexcept>
+#include<utility>
+
+LevelSequence::LevelSequence(std::vector<std::string>&& levelFilenames) : levelFilenames(std::move(levelFilenames)) {
+    if(this->levelFilenames.empty()){
+        throw std::invalid_argument("A level sequence needs at least one level file");
+    }
+}
+
+LevelSequence::~LevelSequence(){
+    try {
+        if(nextLevelTask){
+            JobSystem::wait(nextLevelTask);
+        }
+        JobSystem::wait_all(levelDestructions);
+    } catch(...) {}
+}
+
+bool LevelSequence::build_level_from_file(const char* filename, LevelRegistry& level){
+    LevelBuilder::Context context = LevelBuilder::init_level_parsing(filename);
+    if(context.error){
+        std::cerr << "Error in context initialization of level '" << filename << "'\n";
+        return false;
+    }
+    LevelBuilder::build_level(context, level);
+    if(context.error){
+        std::cerr << "Error in level building of level '" << filename << "'\n";
+        return false;
+    }
+    return true;
+}
+
+bool LevelSequence::start(){
+    if(!build_level_from_file(levelFilenames[0].c_str(), currentLevel)){
+        finished = true;
+        return false;
+    }
+    start_preloading_next_level();
+    return true;
+}
+
+void LevelSequence::start_preloading_next_level(){
+    size_t nextLevelIdx = currentLevelIdx + 1;
+    if(nextLevelIdx >= levelFilenames.size()){
+        nextLevel.reset();
+        nextLevelTask = nullptr;
+        return;
+    }
+    nextLevel = std::make_unique<LevelRegistry>();
+    nextLevelFailed = false;
+    LevelRegistry* level = nextLevel.get();
+    const char* filename = levelFilenames[nextLevelIdx].c_str();
+    nextLevelTask = JobSystem::run_in_background([this, level, filename]{
+        nextLevelFailed = !build_level_from_file(filename, *level);
+    });
+}
+
+void LevelSequence::update(float delta){
+    if(finished){
+        return;
+    }
+    currentLevel.update(delta);
+    if(!currentLevel.is_level_complete()){
+        return;
+    }
+    if(!nextLevelTask){
+        finished = true;
+        return;
+    }
+    // Normally the next level has been ready for a while by now. If it isn't, this waits for it
+    // (uploading its textures in the meantime if this is the main thread, since they need it).
+    JobSystem::wait(nextLevelTask);
+    nextLevelTask = nullptr;
+    if(nextLevelFailed){
+        std::cerr << "Couldn't build level '" << levelFilenames[currentLevelIdx + 1] << "', ending level sequence\n";
+        finished = true;
+        return;
+    }
+    finishedLevels.push_back(FinishedLevel{currentLevelIdx, std::make_unique<LevelRegistry>(std::move(currentLevel))});
+    currentLevel = std::move(*nextLevel);
+    nextLevel.reset();
+    currentLevelIdx++;
+    start_preloading_next_level();
+}
+
+void LevelSequence::release_finished_levels(size_t oldestDrawnLevelIdx){
+    // finished levels are stored in order
+    auto firstKept = std::find_if(finishedLevels.begin(), finishedLevels.end(), [oldestDrawnLevelIdx](const FinishedLevel& finishedLevel){
+        return finishedLevel.levelIdx >= oldestDrawnLevelIdx;
+    });
+    for(auto iter = finishedLevels.begin(); iter != firstKept; iter++){
+        // destroyed in the background too (its textures still get unloaded by the main thread, see
+        // SpriteLoader::unload_texture_from_any_thread)
+        std::shared_ptr<LevelRegistry> level = std::move(iter->level);
+        levelDestructions.push_back(JobSystem::run_in_background([level = std::move(level)]() mutable { level.reset(); }));
+    }
+    finishedLevels.erase(finishedLevels.begin(), firstKept);
+    levelDestructions.erase(std::remove_if(levelDestructions.begin(), levelDestructions.end(), [](const JobSystem::TaskHandle& task){
+        return JobSystem::is_done(task);
+    }), levelDestructions.end());
+}
+
+void LevelSequence::clear(){
+    if(nextLevelTask){
+        JobSystem::wait(nextLevelTask);
+        nextLevelTask = nullptr;
+    }
+    nextLevel.reset();
+    finishedLevels.clear();
+    JobSystem::wait_all(levelDestructions);
+    levelDestructions.clear();
+    currentLevel = LevelRegistry();
+    finished = true;
+}
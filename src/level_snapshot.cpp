@@ -0,0 +1,161 @@
+#include"level_snapshot.h"
+#include"basic_components.h"
+#include"animation_handler.h"
+#include"camera_view.h"
+#include"collision_component.h"
+#include"particle_generator.h"
+#include"player_component.h"
+#include"rng_component.h"
+#include<cstring>
+#include<type_traits>
+
+namespace {
+
+using EntityCount = entt::entt_traits<entt::entity>::entity_type;
+
+// Output archive for entt::snapshot. Components that are plain data are copied byte by byte,
+// the rest only store the fields that change during play.
+class SnapshotWriter {
+  private:
+    std::vector<unsigned char>& buffer;
+
+    template<class T>
+    void write_raw(const T& value){
+        static_assert(std::is_trivially_copyable_v<T>, "Only trivially copyable values can be written as raw bytes");
+        write_bytes(&value, sizeof(T));
+    }
+    void write_bytes(const void* data, size_t size){
+        size_t offset = buffer.size();
+        buffer.resize(offset + size);
+        std::memcpy(buffer.data() + offset, data, size);
+    }
+  public:
+    SnapshotWriter(std::vector<unsigned char>& buffer) : buffer{buffer} {}
+
+    void operator()(EntityCount count){ write_raw(count); }
+    void operator()(entt::entity entity){ write_raw(entity); }
+    void operator()(const Position& pos){ write_raw(pos); }
+    void operator()(const Velocity& vel){ write_raw(vel); }
+    void operator()(const PlayerComponent& player){ write_raw(player); }
+    void operator()(const CollisionEntityStoreComponent& store){ write_raw(store); }
+    void operator()(const CameraView& camera){ write_raw(camera); }
+    void operator()(const RNGComponent& rng){ write_raw(rng); }
+    void operator()(const AnimationHandler& animation){ write_raw(animation.timer); }
+    void operator()(const SpriteSheet& sprite){
+        write_raw(sprite.currentAnimation);
+        write_raw(sprite.currentFrame);
+    }
+    void operator()(const ParticleGenerator& particles){
+        write_raw(particles.particleCurrentSpawnTimer);
+        write_raw(particles.rng);
+        write_raw(particles.clock);
+        write_raw(particles.lastDeathTime);
+        size_t numberParticles = particles.particlePool.size();
+        write_raw(numberParticles);
+        // the pool's arrays are stored one after the other
+        particles.particlePool.for_each_array([this, numberParticles](const auto* array){
+            write_bytes(array, numberParticles * sizeof(*array));
+        });
+    }
+};
+
+// Reads back what SnapshotWriter wrote. EnTT's snapshot loaders create entities and emplace components,
+// but here they already exist, so the values are assigned to them instead. A null target means the
+// entity or component doesn't exist anymore, in which case the data is skipped.
+class SnapshotReader {
+  private:
+    const unsigned char* cursor;
+
+    template<class T>
+    void read_raw(T* target){
+        static_assert(std::is_trivially_copyable_v<T>, "Only trivially copyable values can be read as raw bytes");
+        if(target != nullptr){
+            std::memcpy(target, cursor, sizeof(T));
+        }
+        cursor += sizeof(T);
+    }
+    template<class T>
+    T read_value(){
+        T value;
+        read_raw(&value);
+        return value;
+    }
+
+    void read_into(Position* pos){ read_raw(pos); }
+    void read_into(Velocity* vel){ read_raw(vel); }
+    void read_into(PlayerComponent* player){ read_raw(player); }
+    void read_into(CollisionEntityStoreComponent* store){ read_raw(store); }
+    void read_into(CameraView* camera){ read_raw(camera); }
+    void read_into(RNGComponent* rng){ read_raw(rng); }
+    void read_into(AnimationHandler* animation){ read_raw(animation ? &animation->timer : nullptr); }
+    void read_into(SpriteSheet* sprite){
+        read_raw(sprite ? &sprite->currentAnimation : nullptr);
+        read_raw(sprite ? &sprite->currentFrame : nullptr);
+    }
+    void read_into(ParticleGenerator* particles){
+        read_raw(particles ? &particles->particleCurrentSpawnTimer : nullptr);
+        read_raw(particles ? &particles->rng : nullptr);
+        read_raw(particles ? &particles->clock : nullptr);
+        read_raw(particles ? &particles->lastDeathTime : nullptr);
+        size_t numberParticles = read_value<size_t>();
+        if(particles == nullptr){
+            cursor += numberParticles * ParticlePool::BYTES_PER_PARTICLE;
+            return;
+        }
+        particles->particlePool.resize(numberParticles);
+        particles->particlePool.for_each_array([this, numberParticles](auto* array){
+            std::memcpy(array, cursor, numberParticles * sizeof(*array));
+            cursor += numberParticles * sizeof(*array);
+        });
+    }
+  public:
+    SnapshotReader(const unsigned char* data) : cursor{data} {}
+
+    // Reads the elements of one storage, in the same layout as entt::snapshot::get<Component> writes them.
+    template<class Component>
+    SnapshotReader& get(entt::registry& registry){
+        EntityCount count = read_value<EntityCount>();
+        for(EntityCount i = 0; i < count; i++){
+            entt::entity entity = read_value<entt::entity>();
+            if(entity == entt::null){
+                continue;
+            }
+            read_into(registry.valid(entity) ? registry.try_get<Component>(entity) : nullptr);
+        }
+        return *this;
+    }
+};
+
+}
+
+void take_level_snapshot(const entt::registry& registry, LevelSnapshot& snapshot){
+    snapshot.buffer.clear();
+    SnapshotWriter writer{snapshot.buffer};
+    // NOTE: restore_level_snapshot must read the components in this same order
+    entt::snapshot{registry}
+        .get<Position>(writer)
+        .get<Velocity>(writer)
+        .get<PlayerComponent>(writer)
+        .get<CollisionEntityStoreComponent>(writer)
+        .get<CameraView>(writer)
+        .get<AnimationHandler>(writer)
+        .get<SpriteSheet>(writer)
+        .get<ParticleGenerator>(writer)
+        .get<RNGComponent>(writer);
+}
+
+void restore_level_snapshot(entt::registry& registry, const LevelSnapshot& snapshot){
+    if(snapshot.buffer.empty()){
+        return;
+    }
+    SnapshotReader{snapshot.buffer.data()}
+        .get<Position>(registry)
+        .get<Velocity>(registry)
+        .get<PlayerComponent>(registry)
+        .get<CollisionEntityStoreComponent>(registry)
+        .get<CameraView>(registry)
+        .get<AnimationHandler>(registry)
+        .get<SpriteSheet>(registry)
+        .get<ParticleGenerator>(registry)
+        .get<RNGComponent>(registry);
+}
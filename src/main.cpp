@@ -1,32 +1,127 @@
 #include<raylib.h>
 #include"entt.hpp"
 #include"level_registry.h"
-#include"level_builder.h"
+#include"level_sequence.h"
+#include"job_system.h"
+#include"simulation_thread.h"
+#include"asset_files.h"
+#include"sprite_loader.h"
+#include"sound_loader.h"
+#include"voice_pool.h"
 #include<iostream>
 #include<chrono>
+#include<string>
+#include<vector>
 
 const int SCREENWIDTH = 800;
 const int SCREENHEIGHT = 600;
-static const char* LEVEL_FILENAME = "/home/eduardo-r/Projects/ultimatesupermegagolf/resources/levels_json/test_level_colliders.json";
+static const char* DEFAULT_LEVEL_FILENAME = "/home/eduardo-r/Projects/ultimatesupermegagolf/resources/levels_json/test_level_colliders.json";
+// Levels to play, in order. Each one is loaded in the background while the previous one is played.
+static std::vector<std::string> LEVEL_FILENAMES;
 static bool DEBUG_MODE_ENABLED = false;
+// If true, levels are updated on their own thread while the main thread draws (see SimulationThread)
+static bool PIPELINED_MODE_ENABLED = false;
+// Asset archive to read assets from, if any (see AssetFiles)
+static const char* ASSET_ARCHIVE_FILENAME = nullptr;
 
 void parse_args(int argc, char** argv){
-    if(argc < 2){
-        return;
-    } else {
-        bool setLevelFilename = false;
-        for(int argIdx = 1; argIdx < argc; argIdx++){
-            const char* arg_i = argv[argIdx];
-            if(std::string(arg_i) == "-d" || std::string(arg_i) == "--debug"){
-                DEBUG_MODE_ENABLED = true;
-            } else if(!setLevelFilename){
-                LEVEL_FILENAME = arg_i;
-            } else {
-                std::cerr << "Too many arguments! Expected at most one level filename to load and an optional '-d' or '--debug' flag\n";
-                exit(-1);
-            }
+    for(int argIdx = 1; argIdx < argc; argIdx++){
+        const char* arg_i = argv[argIdx];
+        if(std::string(arg_i) == "-d" || std::string(arg_i) == "--debug"){
+            DEBUG_MODE_ENABLED = true;
+        } else if(std::string(arg_i) == "-p" || std::string(arg_i) == "--pipelined"){
+            PIPELINED_MODE_ENABLED = true;
+        } else if((std::string(arg_i) == "-a" || std::string(arg_i) == "--archive") && argIdx + 1 < argc){
+            ASSET_ARCHIVE_FILENAME = argv[++argIdx];
+        } else {
+            LEVEL_FILENAMES.push_back(arg_i);
         }
     }
+    if(LEVEL_FILENAMES.empty()){
+        LEVEL_FILENAMES.push_back(DEFAULT_LEVEL_FILENAME);
+    }
+}
+
+// Debug camera controls pressed this frame.
+struct CameraControls {
+    bool zoomIn, zoomOut, up, down, left, right, rotateLeft, rotateRight;
+};
+
+CameraControls sample_camera_controls(){
+    return CameraControls{
+        .zoomIn = IsKeyDown(KEY_KP_ADD),
+        .zoomOut = IsKeyDown(KEY_KP_SUBTRACT),
+        .up = IsKeyDown(KEY_W),
+        .down = IsKeyDown(KEY_S),
+        .left = IsKeyDown(KEY_A),
+        .right = IsKeyDown(KEY_D),
+        .rotateLeft = IsKeyDown(KEY_Q),
+        .rotateRight = IsKeyDown(KEY_E)
+    };
+}
+
+void apply_camera_controls(LevelRegistry& level, const CameraControls& controls){
+    // fetched every frame, since the level changes when the current one is complete
+    CameraView& camera = *level.get_component<CameraView>(level.get_camera_entity());
+    if(controls.zoomIn){
+        zoom_camera(camera, 1.01, CAMERA_ZOOM_IN);
+    } else if(controls.zoomOut){
+        zoom_camera(camera, 1.01, CAMERA_ZOOM_OUT);
+    }
+    if(controls.up){
+        move_camera(camera, {0, -1});
+    }
+    if(controls.down){
+        move_camera(camera, {0, 1});
+    }
+    if(controls.left){
+        move_camera(camera, {-1, 0});
+    }
+    if(controls.right){
+        move_camera(camera, {1, 0});
+    }
+    if(controls.rotateLeft){
+        camera->rotation -= 1;
+    }
+    if(controls.rotateRight){
+        camera->rotation += 1;
+    }
+}
+
+// Updates and draws the levels one after the other on the main thread.
+void run_serial(LevelSequence& levels){
+    while(!WindowShouldClose() && !levels.is_finished()){
+        float delta = GetFrameTime();
+        JobSystem::process_main_thread_jobs();
+        levels.current().set_input(sample_input());
+        levels.update(delta);
+        LevelRegistry& level = levels.current();
+        level.draw(DEBUG_MODE_ENABLED);
+        // only the current level is ever drawn in this mode
+        levels.release_finished_levels(levels.current_level_index());
+        apply_camera_controls(level, sample_camera_controls());
+        //std::cout << "camera coordinates: " << GetScreenToWorld2D({0,0}, camera.cam) << " to " << GetScreenToWorld2D({SCREENWIDTH, SCREENHEIGHT}, camera.cam) << '\n';
+        //std::cout << "\tplayer position: " << to_Vector2(registry.get().get<Position>(registry.get_entity(registry.PLAYER_ENTITY_NAME))) << '\n';
+    }
+}
+
+// Updates the levels on a simulation thread, while the main thread draws the previous frame and
+// samples the input. Debug collision and bounding box overlays aren't drawn in this mode.
+void run_pipelined(LevelSequence& levels){
+    SimulationThread simulation{levels};
+    simulation.start();
+    while(!WindowShouldClose() && !simulation.is_finished()){
+        float delta = GetFrameTime();
+        JobSystem::process_main_thread_jobs();
+        simulation.push_command([input = sample_input(), controls = sample_camera_controls()](LevelSequence& levels){
+            LevelRegistry& level = levels.current();
+            level.set_input(input);
+            apply_camera_controls(level, controls);
+        });
+        simulation.request_update(delta);
+        simulation.draw(DEBUG_MODE_ENABLED);
+    }
+    simulation.stop();
 }
 
 int main(int argc, char** argv){
@@ -34,61 +129,45 @@ int main(int argc, char** argv){
     InitWindow(SCREENWIDTH, SCREENHEIGHT, "Ultimate Super Mega Golf");
     InitAudioDevice();
     SetTargetFPS(60);
-    LevelRegistry level;
+    JobSystem::init();
+    if(ASSET_ARCHIVE_FILENAME != nullptr && !AssetFiles::mount_archive(ASSET_ARCHIVE_FILENAME)){
+        std::cerr << "Couldn't open asset archive '" << ASSET_ARCHIVE_FILENAME << "', using loose files\n";
+    }
+    LevelSequence levels{std::move(LEVEL_FILENAMES)};
     {
         auto start = std::chrono::high_resolution_clock::now();
 
-        LevelBuilder::Context context = LevelBuilder::init_level_parsing(LEVEL_FILENAME);
-        if(context.error){
-            std::cerr << "Error in context initialization, exiting...\n";
+        if(!levels.start()){
+            std::cerr << "Error in level building, exiting...\n";
             exit(1);
         }
-        LevelBuilder::build_level(context, level);
 
         auto end = std::chrono::high_resolution_clock::now();
         using milliseconds = std::chrono::duration<float, std::milli>;
         auto ms = std::chrono::duration_cast<milliseconds>(end - start);
         std::cout << "Level parsing complete, time taken: " << ms.count() << "ms\n";
-        if(context.error){
-            std::cerr << "Error in level building, exiting...\n";
-            exit(2);
-        }
+        AssetStats textures = SpriteLoader::get_texture_stats();
+        AssetStats sounds = SoundLoader::get_sound_stats();
+        std::cout << "Loaded assets: " << textures.liveAssets << " textures (" << textures.bytes / 1024 << " KiB), "
+                  << sounds.liveAssets << " sounds (" << sounds.bytes / 1024 << " KiB)\n";
     }
 
-    CameraView& camera = *level.get_component<CameraView>(level.get_entity(level.CAMERA_ENTITY_NAME));
-
-    while(!WindowShouldClose()){
-        float delta = GetFrameTime();
-        level.update(delta);
-        level.draw(DEBUG_MODE_ENABLED);
-        if(IsKeyDown(KEY_KP_ADD)){
-            zoom_camera(camera, 1.01, CAMERA_ZOOM_IN);
-        } else if(IsKeyDown(KEY_KP_SUBTRACT)){
-            zoom_camera(camera, 1.01, CAMERA_ZOOM_OUT);
-        }
-        if(IsKeyDown(KEY_W)){
-            move_camera(camera, {0, -1});
-        }
-        if(IsKeyDown(KEY_S)){
-            move_camera(camera, {0, 1});
-        }
-        if(IsKeyDown(KEY_A)){
-            move_camera(camera, {-1, 0});
-        }
-        if(IsKeyDown(KEY_D)){
-            move_camera(camera, {1, 0});
-        }
-        if(IsKeyDown(KEY_Q)){
-            camera->rotation -= 1;
-        }
-        if(IsKeyDown(KEY_E)){
-            camera->rotation += 1;
-        }
-        //std::cout << "camera coordinates: " << GetScreenToWorld2D({0,0}, camera.cam) << " to " << GetScreenToWorld2D({SCREENWIDTH, SCREENHEIGHT}, camera.cam) << '\n';
-        //std::cout << "\tplayer position: " << to_Vector2(registry.get().get<Position>(registry.get_entity(registry.PLAYER_ENTITY_NAME))) << '\n';
+    if(PIPELINED_MODE_ENABLED){
+        run_pipelined(levels);
+    } else {
+        run_serial(levels);
     }
 
-    level.get().clear();
+    // every level (including the one preloaded in the background) unloads its assets while the
+    // window and the audio device are still open
+    levels.clear();
+    JobSystem::shutdown();
+    if(DEBUG_MODE_ENABLED){
+        VoicePool::VoiceStats voices = VoicePool::get_stats();
+        std::cout << "Sounds played: " << voices.played << " (" << voices.stolen << " stealing a voice), "
+                  << voices.merged << " merged, " << voices.culled << " culled, " << voices.dropped << " dropped\n";
+    }
+    VoicePool::clear();
     CloseAudioDevice();
     CloseWindow();
 }
\ No newline at end of file
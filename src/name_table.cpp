@@ -0,0 +1,70 @@
+#include"name_table.h"
+#include<algorithm>
+#include<charconv>
+#include<cstring>
+#include<limits>
+#include<stdexcept>
+#include<utility>
+
+NameTable::NameTable(std::pmr::memory_resource* resource) : resource{resource}, entries{resource}, chunks{resource} {}
+
+NameTable::~NameTable(){
+    for(auto[chunk, capacity] : chunks){
+        resource->deallocate(chunk, capacity, 1);
+    }
+}
+
+NameTable::NameTable(NameTable&& other) :
+    resource{other.resource},
+    entries{std::move(other.entries)},
+    chunks{std::move(other.chunks)},
+    currentChunk{other.currentChunk},
+    currentChunkUsed{other.currentChunkUsed},
+    currentChunkCapacity{other.currentChunkCapacity}
+{
+    other.chunks.clear();
+    other.currentChunk = nullptr;
+    other.currentChunkUsed = 0;
+    other.currentChunkCapacity = 0;
+}
+
+char* NameTable::reserve_characters(size_t size){
+    if(currentChunk == nullptr || currentChunkUsed + size > currentChunkCapacity){
+        size_t capacity = std::max(size, CHUNK_SIZE);
+        currentChunk = static_cast<char*>(resource->allocate(capacity, 1));
+        chunks.emplace_back(currentChunk, capacity);
+        currentChunkUsed = 0;
+        currentChunkCapacity = capacity;
+    }
+    char* output = currentChunk + currentChunkUsed;
+    currentChunkUsed += size;
+    return output;
+}
+
+NameHandle NameTable::add_entry(const char* data, size_t size){
+    if(entries.size() >= std::numeric_limits<NameHandle>::max()){
+        throw std::length_error("Too many names in name table");
+    }
+    entries.push_back(Entry{
+        .data = data,
+        .size = (uint32_t)size,
+        .hash = util::hash_string(data, size)
+    });
+    return (NameHandle)(entries.size() - 1);
+}
+
+NameHandle NameTable::add(std::string_view name){
+    char* data = reserve_characters(name.size());
+    std::memcpy(data, name.data(), name.size());
+    return add_entry(data, name.size());
+}
+
+NameHandle NameTable::add_numbered(std::string_view prefix, unsigned int number){
+    char digits[std::numeric_limits<unsigned int>::digits10 + 1];
+    size_t numberDigits = std::to_chars(digits, digits + sizeof(digits), number).ptr - digits;
+    size_t size = prefix.size() + numberDigits;
+    char* data = reserve_characters(size);
+    std::memcpy(data, prefix.data(), prefix.size());
+    std::memcpy(data + prefix.size(), digits, numberDigits);
+    return add_entry(data, size);
+}
@@ -2,24 +2,32 @@
 #include"basic_components.h"
 #include"raylib.h"
 #include "rng_component.h"
+#include "utility/rlgl_subset.h"
+#include <algorithm>
+#include <cmath>
 #include <cstddef>
-#include <execution>
 #include<utility>
+#include<vector>
 
-static const size_t MAX_PARTICLES_PER_GENERATOR = 512;
-
-ParticleGenerator new_particle_generator(ParticleSettings&& settings){
-    size_t initialCapacity = std::max(32, settings.spawnQuantity.max);
-    if(settings.lifetime.max >= settings.spawnPeriod.max){
-        initialCapacity *= 2;
+// Returns the most particles that can be alive at once with the given settings, capped to MAX_PARTICLES_PER_GENERATOR.
+static size_t max_particles_alive(const ParticleSettings& settings){
+    size_t perSpawn = std::max(settings.spawnQuantity.max, 1);
+    // a particle lives at most lifetime.max, and spawns happen at most every spawnPeriod.min
+    double spawnsAlive = std::ceil(settings.lifetime.max / settings.spawnPeriod.min) + 1;
+    if(!(spawnsAlive * perSpawn < MAX_PARTICLES_PER_GENERATOR)){ // also catches NaN and infinity
+        return MAX_PARTICLES_PER_GENERATOR;
     }
-    ParticleGenerator result = ParticleGenerator {
+    return std::max((size_t)spawnsAlive, (size_t)1) * perSpawn;
+}
+
+ParticleGenerator new_particle_generator(ParticleSettings&& settings, const RNGComponent& rng){
+    size_t capacity = max_particles_alive(settings);
+    return ParticleGenerator {
         .settings = std::move(settings),
-        .particlePool = {},
-        .particleCurrentSpawnTimer = 0.f
+        .particlePool = ParticlePool(capacity),
+        .particleCurrentSpawnTimer = 0.f,
+        .rng = rng
     };
-    result.particlePool.reserve(initialCapacity);
-    return result;
 }
 
 void particle_generator_enable(ParticleGenerator& particles){
@@ -37,59 +45,231 @@ void particle_generator_disable(ParticleGenerator& particles){
 void particle_generator_reset(ParticleGenerator& particles){
     particles.particlePool.clear();
     particles.particleCurrentSpawnTimer = 0.f;
+    particles.lastDeathTime = particles.clock;
 }
 
 size_t particle_generator_current_number_of_particles(const ParticleGenerator& particles){
     return particles.particlePool.size();
 }
 
-void particle_generator_draw(const ParticleGenerator& particles, const Position& pos){
-    Texture texture = particles.settings.texture;
-    Vector2 posVector = to_Vector2(pos);
-    for(const Particle& particle : particles.particlePool){
-        particle.draw(texture, posVector);
+// Maximum number of particles written to raylib's render batch between checks of its remaining space.
+static const size_t PARTICLE_BATCH_SIZE = 1024;
+
+// (private) Scratch buffers for the quads of a generator's particles, in structure-of-arrays form so that
+// computing the corners vectorizes. Reused between calls (one per thread).
+struct ParticleQuadBuffer {
+    // State of the particles at the generator's current time (see ParticlePool::evaluate)
+    std::vector<float> positionX, positionY, angle, age;
+    // Center of the quad, and half of its rotated horizontal (u) and vertical (v) sides
+    std::vector<float> centerX, centerY, uX, uY, vX, vY;
+    // Corners in drawing order: top left, bottom left, bottom right, top right
+    std::vector<float> cornerX[4], cornerY[4];
+
+    void resize(size_t count){
+        for(std::vector<float>* buffer : {&positionX, &positionY, &angle, &age, &centerX, &centerY, &uX, &uY, &vX, &vY}){
+            buffer->resize(count);
+        }
+        for(size_t corner = 0; corner < 4; corner++){
+            cornerX[corner].resize(count);
+            cornerY[corner].resize(count);
+        }
+    }
+};
+
+// Computes one corner of `count` quads: corner = center + uSign * u + vSign * v. Plain arithmetic on
+// contiguous arrays, which the compiler vectorizes (restrict parameters, so it knows they don't overlap).
+static void compute_quad_corner(float* __restrict cornerX, float* __restrict cornerY,
+                                const float* __restrict centerX, const float* __restrict centerY,
+                                const float* __restrict uX, const float* __restrict uY,
+                                const float* __restrict vX, const float* __restrict vY,
+                                float uSign, float vSign, size_t count){
+    for(size_t i = 0; i < count; i++){
+        cornerX[i] = centerX[i] + uSign * uX[i] + vSign * vX[i];
+        cornerY[i] = centerY[i] + uSign * uY[i] + vSign * vY[i];
     }
 }
 
-static void particle_generator_erase_dead_particles(ParticleGenerator& particles){
-    for(size_t i = 0; i < particles.particlePool.size(); /*noop*/){
-        if(particles.particlePool[i].shouldDie()){
-            std::swap<Particle>(particles.particlePool[i], particles.particlePool.back());
-            particles.particlePool.pop_back();
-        } else {
-            i++;
+void particle_generator_write_quads(const ParticleGenerator& particles, const Position& pos, std::vector<ParticleQuad>& output){
+    thread_local ParticleQuadBuffer quads;
+    const Texture& texture = particles.settings.texture;
+    const ParticlePool& pool = particles.particlePool;
+    size_t count = pool.size();
+    if(count == 0){
+        return;
+    }
+    quads.resize(count);
+    float halfWidth = texture.width / 2.f;
+    float halfHeight = texture.height / 2.f;
+    pool.evaluate(particles.clock, particles.settings.acceleration, quads.positionX.data(), quads.positionY.data(), quads.angle.data(), quads.age.data());
+    for(size_t i = 0; i < count; i++){
+        float angle = quads.angle[i] * DEG2RAD;
+        float cosAngle = std::cos(angle);
+        float sinAngle = std::sin(angle);
+        quads.centerX[i] = pos.x + quads.positionX[i];
+        quads.centerY[i] = pos.y + quads.positionY[i];
+        quads.uX[i] = halfWidth * cosAngle;
+        quads.uY[i] = halfWidth * sinAngle;
+        quads.vX[i] = -halfHeight * sinAngle;
+        quads.vY[i] = halfHeight * cosAngle;
+    }
+    // top left: -u -v, bottom left: -u +v, bottom right: +u +v, top right: +u -v
+    static const float U_SIGNS[4] = {-1, -1, 1, 1};
+    static const float V_SIGNS[4] = {-1, 1, 1, -1};
+    for(size_t corner = 0; corner < 4; corner++){
+        compute_quad_corner(quads.cornerX[corner].data(), quads.cornerY[corner].data(), quads.centerX.data(), quads.centerY.data(),
+                            quads.uX.data(), quads.uY.data(), quads.vX.data(), quads.vY.data(), U_SIGNS[corner], V_SIGNS[corner], count);
+    }
+    const float* lifetimes = pool.lifetimes();
+    const Color* colors = pool.colors();
+    size_t firstQuad = output.size();
+    output.resize(firstQuad + count);
+    size_t numberAlive = 0;
+    for(size_t i = 0; i < count; i++){
+        // particles of generators updated with particle_generator_advance_clock may be dead already
+        if(quads.age[i] >= lifetimes[i]){
+            continue;
+        }
+        ParticleQuad& quad = output[firstQuad + numberAlive++];
+        for(size_t corner = 0; corner < 4; corner++){
+            quad.corners[corner] = Vector2{quads.cornerX[corner][i], quads.cornerY[corner][i]};
+        }
+        quad.color = colors[i];
+        if(particles.settings.fadeOut){
+            quad.color.a = (unsigned char)(quad.color.a * (1.f - quads.age[i] / lifetimes[i]));
         }
     }
+    output.resize(firstQuad + numberAlive);
+}
+
+void draw_particle_quads(const Texture& texture, const ParticleQuad* quads, size_t count){
+    if(count == 0 || texture.id == 0){
+        return;
+    }
+    // every particle goes into the same batch with the texture bound once (unless the batch fills up)
+    static const float TEXCOORD_X[4] = {0, 0, 1, 1};
+    static const float TEXCOORD_Y[4] = {0, 1, 1, 0};
+    for(size_t begin = 0; begin < count; begin += PARTICLE_BATCH_SIZE){
+        size_t end = std::min(begin + PARTICLE_BATCH_SIZE, count);
+        rlCheckRenderBatchLimit(4 * (end - begin));
+        rlSetTexture(texture.id);
+        rlBegin(RL_QUADS);
+            rlNormal3f(0.0f, 0.0f, 1.0f);
+            for(size_t i = begin; i < end; i++){
+                const ParticleQuad& quad = quads[i];
+                rlColor4ub(quad.color.r, quad.color.g, quad.color.b, quad.color.a);
+                for(size_t corner = 0; corner < 4; corner++){
+                    rlTexCoord2f(TEXCOORD_X[corner], TEXCOORD_Y[corner]);
+                    rlVertex2f(quad.corners[corner].x, quad.corners[corner].y);
+                }
+            }
+        rlEnd();
+    }
+    rlSetTexture(0);
+}
+
+void particle_generator_draw(const ParticleGenerator& particles, const Position& pos){
+    static std::vector<ParticleQuad> quads; // only ever drawn from the main thread
+    quads.clear();
+    particle_generator_write_quads(particles, pos, quads);
+    draw_particle_quads(particles.settings.texture, quads.data(), quads.size());
 }
 
-static void particle_generator_spawn_particles(ParticleGenerator& particles, RNGComponent& rng){
+// Maximum number of particles whose random values are generated at once when spawning
+static const size_t PARTICLE_SPAWN_BATCH_SIZE = 64;
+
+static size_t particle_generator_spawn_particles(ParticleGenerator& particles, size_t spawnAllowance){
+    RNGComponent& rng = particles.rng;
     size_t numberToSpawn = particles.settings.spawnQuantity.get_random_fast(rng);
-    ParticleSettings& settings = particles.settings;
-    for(size_t i = 0; i < numberToSpawn; i++){
-        Vector2 spawnPoint = Vector2 {
-            settings.spawningArea.x + random_float(rng, settings.spawningArea.width),
-            settings.spawningArea.y + random_float(rng, settings.spawningArea.height)
-        };
-        particles.particlePool.emplace_back(
-            settings.color.get_random(rng),
-            spawnPoint,
-            settings.initialVelocity.get_random(rng),
-            settings.acceleration,
-            settings.initialRotation.get_random(rng),
-            settings.rotationalVelocity.get_random(rng),
-            settings.lifetime.get_random(rng)
-        );
-    }
-}
-
-void particle_generator_update(ParticleGenerator& particles, RNGComponent& rng, float delta){
+    size_t freeSpace = particles.particlePool.capacity() - particles.particlePool.size();
+    numberToSpawn = std::min({numberToSpawn, spawnAllowance, freeSpace});
+    const ParticleSettings& settings = particles.settings;
+    // every value is generated for a whole batch of particles at once (see random_floats)
+    float spawnX[PARTICLE_SPAWN_BATCH_SIZE], spawnY[PARTICLE_SPAWN_BATCH_SIZE];
+    float velocityX[PARTICLE_SPAWN_BATCH_SIZE], velocityY[PARTICLE_SPAWN_BATCH_SIZE];
+    float angle[PARTICLE_SPAWN_BATCH_SIZE], rotationalVelocity[PARTICLE_SPAWN_BATCH_SIZE];
+    float lifetime[PARTICLE_SPAWN_BATCH_SIZE];
+    Color color[PARTICLE_SPAWN_BATCH_SIZE];
+    for(size_t begin = 0; begin < numberToSpawn; begin += PARTICLE_SPAWN_BATCH_SIZE){
+        size_t batchSize = std::min(numberToSpawn - begin, PARTICLE_SPAWN_BATCH_SIZE);
+        random_floats(rng, spawnX, batchSize, settings.spawningArea.x, settings.spawningArea.x + settings.spawningArea.width);
+        random_floats(rng, spawnY, batchSize, settings.spawningArea.y, settings.spawningArea.y + settings.spawningArea.height);
+        settings.color.get_random(rng, color, batchSize);
+        settings.initialVelocity.get_random(rng, velocityX, velocityY, batchSize);
+        settings.initialRotation.get_random(rng, angle, batchSize);
+        settings.rotationalVelocity.get_random(rng, rotationalVelocity, batchSize);
+        settings.lifetime.get_random(rng, lifetime, batchSize);
+        for(size_t i = 0; i < batchSize; i++){
+            particles.particlePool.add(color[i], {spawnX[i], spawnY[i]}, {velocityX[i], velocityY[i]},
+                                       angle[i], rotationalVelocity[i], particles.clock, lifetime[i]);
+            particles.lastDeathTime = std::max(particles.lastDeathTime, particles.clock + lifetime[i]);
+        }
+    }
+    return numberToSpawn;
+}
+
+// Clock time after which the clock is moved back to zero
+static const float PARTICLE_CLOCK_REBASE_TIME = 1024.f;
+
+// Advances the generator's clock, moving it (and every time relative to it) back to zero once it gets big
+// enough to start losing precision.
+static void advance_clock(ParticleGenerator& particles, float delta){
+    particles.clock += delta;
+    if(particles.clock >= PARTICLE_CLOCK_REBASE_TIME){
+        float offset = particles.clock;
+        particles.particlePool.shift_birth_times(offset);
+        particles.lastDeathTime -= offset;
+        particles.clock = 0.f;
+    }
+}
+
+size_t particle_generator_max_spawned(const ParticleGenerator& particles, float delta){
+    if(particles.particleCurrentSpawnTimer - delta > 0.f){
+        return 0;
+    }
+    size_t freeSpace = particles.particlePool.capacity() - particles.particlePool.size();
+    return std::min((size_t)std::max(particles.settings.spawnQuantity.max, 0), freeSpace);
+}
+
+size_t particle_generator_update(ParticleGenerator& particles, float delta, size_t spawnAllowance){
+    size_t numberSpawned = 0;
+    advance_clock(particles, delta);
+    particles.particlePool.remove_dead(particles.clock);
     particles.particleCurrentSpawnTimer -= delta;
     if(particles.particleCurrentSpawnTimer <= 0.f){
-        particle_generator_spawn_particles(particles, rng);
-        particles.particleCurrentSpawnTimer = particles.settings.spawnPeriod.get_random(rng);
+        numberSpawned = particle_generator_spawn_particles(particles, spawnAllowance);
+        particles.particleCurrentSpawnTimer = particles.settings.spawnPeriod.get_random(particles.rng);
+    }
+    return numberSpawned;
+}
+
+void particle_generator_advance_clock(ParticleGenerator& particles, float delta){
+    advance_clock(particles, delta);
+    if(particles.clock >= particles.lastDeathTime){
+        particles.particlePool.clear();
     }
-    for(Particle& particle : particles.particlePool){
-        particle.update(delta);
+    particles.particleCurrentSpawnTimer -= delta;
+    if(particles.particleCurrentSpawnTimer <= 0.f){
+        particles.particleCurrentSpawnTimer = particles.settings.spawnPeriod.get_random(particles.rng);
     }
-    particle_generator_erase_dead_particles(particles);
+}
+
+// Returns the furthest a particle can get from its spawn point along one axis in the given time, with its
+// initial velocity within the given range and the given constant acceleration.
+static float max_travel(float minVelocity, float maxVelocity, float acceleration, float time){
+    float maxSpeed = std::max(std::abs(minVelocity), std::abs(maxVelocity));
+    return maxSpeed * time + std::abs(acceleration) * time * time / 2;
+}
+
+WorldAABB particle_generator_bounds(const ParticleGenerator& particles, const Position& pos){
+    const ParticleSettings& settings = particles.settings;
+    float lifetime = settings.lifetime.max;
+    // the texture's diagonal covers the quad with any rotation
+    float halfDiagonal = std::sqrt((float)(settings.texture.width * settings.texture.width + settings.texture.height * settings.texture.height)) / 2;
+    Vector2 margin = {
+        max_travel(settings.initialVelocity.min.x, settings.initialVelocity.max.x, settings.acceleration.x, lifetime) + halfDiagonal,
+        max_travel(settings.initialVelocity.min.y, settings.initialVelocity.max.y, settings.acceleration.y, lifetime) + halfDiagonal
+    };
+    Vector2 spawnMin = to_Vector2(pos) + Vector2{settings.spawningArea.x, settings.spawningArea.y};
+    Vector2 spawnMax = spawnMin + Vector2{settings.spawningArea.width, settings.spawningArea.height};
+    return WorldAABB{spawnMin - margin, spawnMax + margin};
 }
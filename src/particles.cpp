@@ -1,43 +1,130 @@
 #include"particles.h"
 #include "raylib.h"
+#include<algorithm>
+#include<stdexcept>
+#include<utility>
 
-Particle::Particle(
+ParticlePool::ParticlePool(size_t capacity) :
+    m_floats(std::make_unique<float[]>(NUMBER_FLOAT_ARRAYS * capacity)),
+    m_colors(std::make_unique<Color[]>(capacity)),
+    m_capacity(capacity),
+    m_size(0) {}
+
+ParticlePool::ParticlePool(const ParticlePool& other) : ParticlePool(other.m_capacity) {
+    m_size = other.m_size;
+    for(size_t index = 0; index < NUMBER_FLOAT_ARRAYS; index++){
+        std::copy_n(other.array((FloatArray)index), m_size, array((FloatArray)index));
+    }
+    std::copy_n(other.m_colors.get(), m_size, m_colors.get());
+}
+
+ParticlePool& ParticlePool::operator=(const ParticlePool& other){
+    if(this != &other){
+        *this = ParticlePool(other);
+    }
+    return *this;
+}
+
+ParticlePool::ParticlePool(ParticlePool&& other) :
+    m_floats(std::move(other.m_floats)),
+    m_colors(std::move(other.m_colors)),
+    m_capacity(std::exchange(other.m_capacity, 0)),
+    m_size(std::exchange(other.m_size, 0)) {}
+
+ParticlePool& ParticlePool::operator=(ParticlePool&& other){
+    m_floats = std::move(other.m_floats);
+    m_colors = std::move(other.m_colors);
+    m_capacity = std::exchange(other.m_capacity, 0);
+    m_size = std::exchange(other.m_size, 0);
+    return *this;
+}
+
+bool ParticlePool::add(
     const Color& color,
     const Vector2& relativePos,
     const Vector2& velocity,
-    const Vector2& acceleration,
     float angle,
     float rotationalVelocity,
+    float birthTime,
     float lifetime
-) : m_color(color),
-    m_relativePos(relativePos),
-    m_velocity(velocity),
-    m_acceleration(acceleration),
-    m_currentAngle(angle),
-    m_rotationalVelocity(rotationalVelocity),
-    m_timeToLive(lifetime) {};
-
-
-void Particle::update(float delta){
-    m_velocity += m_acceleration * delta;
-    m_relativePos += m_velocity * delta;
-    m_currentAngle += m_rotationalVelocity * delta;
-    m_timeToLive -= delta;
-}
-
-bool Particle::shouldDie() const {
-    return (m_timeToLive <= 0.0f);
-}
-
-void Particle::draw(const Texture& texture, const Vector2& position) const {
-    int width = texture.width;
-    int height = texture.height;
-    Rectangle rectFrom = Rectangle {0, 0, width, height};
-    Rectangle rectTo = Rectangle {
-        .x = -width/2.f,
-        .y = -height/2.f,
-        .width = width,
-        .height = height
-    };
-    DrawTexturePro(texture, rectFrom, rectTo, position + m_relativePos, m_currentAngle, m_color);
+){
+    if(full()){
+        return false;
+    }
+    size_t i = m_size++;
+    array(POS_X)[i] = relativePos.x;
+    array(POS_Y)[i] = relativePos.y;
+    array(VEL_X)[i] = velocity.x;
+    array(VEL_Y)[i] = velocity.y;
+    array(ANGLE)[i] = angle;
+    array(ROTATIONAL_VELOCITY)[i] = rotationalVelocity;
+    array(BIRTH_TIME)[i] = birthTime;
+    array(LIFETIME)[i] = lifetime;
+    m_colors[i] = color;
+    return true;
+}
+
+// Closed-form state of `count` particles at the given time. Plain arithmetic on contiguous arrays, which
+// the compiler vectorizes (restrict parameters, so it knows they don't overlap).
+static void evaluate_particles(const float* __restrict posX, const float* __restrict posY,
+                               const float* __restrict velX, const float* __restrict velY,
+                               const float* __restrict angle, const float* __restrict rotationalVelocity,
+                               const float* __restrict birthTime, float time, float halfAccelX, float halfAccelY,
+                               float* __restrict outX, float* __restrict outY,
+                               float* __restrict outAngle, float* __restrict outAge, size_t count){
+    for(size_t i = 0; i < count; i++){
+        float t = time - birthTime[i];
+        outX[i] = posX[i] + (velX[i] + halfAccelX * t) * t;
+        outY[i] = posY[i] + (velY[i] + halfAccelY * t) * t;
+        outAngle[i] = angle[i] + rotationalVelocity[i] * t;
+        outAge[i] = t;
+    }
+}
+
+void ParticlePool::evaluate(float time, const Vector2& acceleration, float* outX, float* outY, float* outAngle, float* outAge) const{
+    evaluate_particles(array(POS_X), array(POS_Y), array(VEL_X), array(VEL_Y), array(ANGLE), array(ROTATIONAL_VELOCITY),
+                       array(BIRTH_TIME), time, acceleration.x / 2, acceleration.y / 2, outX, outY, outAngle, outAge, m_size);
+}
+
+void ParticlePool::remove_dead(float time){
+    float* posX = array(POS_X);
+    float* posY = array(POS_Y);
+    float* velX = array(VEL_X);
+    float* velY = array(VEL_Y);
+    float* angle = array(ANGLE);
+    float* rotationalVelocity = array(ROTATIONAL_VELOCITY);
+    float* birthTime = array(BIRTH_TIME);
+    float* lifetime = array(LIFETIME);
+    Color* color = m_colors.get();
+    // every particle is copied to the next free slot, which only moves forward if the particle is
+    // alive, so dead particles get overwritten by the next alive one without any branches
+    size_t alive = 0;
+    for(size_t i = 0; i < m_size; i++){
+        bool isAlive = (time - birthTime[i] < lifetime[i]);
+        posX[alive] = posX[i];
+        posY[alive] = posY[i];
+        velX[alive] = velX[i];
+        velY[alive] = velY[i];
+        angle[alive] = angle[i];
+        rotationalVelocity[alive] = rotationalVelocity[i];
+        birthTime[alive] = birthTime[i];
+        lifetime[alive] = lifetime[i];
+        color[alive] = color[i];
+        alive += isAlive;
+    }
+    m_size = alive;
+}
+
+void ParticlePool::shift_birth_times(float offset){
+    float* birthTime = array(BIRTH_TIME);
+    for(size_t i = 0; i < m_size; i++){
+        birthTime[i] -= offset;
+    }
+}
+
+void ParticlePool::resize(size_t size){
+    if(size > m_capacity){
+        throw std::length_error("Particle pool resized past its capacity");
+    }
+    m_size = size;
 }
@@ -1,16 +1,27 @@
 #include"player_component.h"
 #include<cassert>
 
-void update_input(InputManager& input){
-    input.mouseScreenPosition = GetMousePosition();
+InputSample sample_input(){
+    InputSample sample;
+    sample.mouseScreenPosition = GetMousePosition();
+    sample.keys[InputManager::LEFT]        = IsKeyDown(KEY_LEFT);
+    sample.keys[InputManager::RIGHT]       = IsKeyDown(KEY_RIGHT);
+    sample.keys[InputManager::DOWN]        = IsKeyDown(KEY_DOWN);
+    sample.keys[InputManager::UP]          = IsKeyDown(KEY_UP);
+    sample.keys[InputManager::PAUSE]       = IsKeyDown(KEY_ENTER);
+    sample.keys[InputManager::RESET]       = IsKeyDown(KEY_R);
+    sample.keys[InputManager::MOUSE_CLICK] = IsMouseButtonDown(MOUSE_BUTTON_LEFT);
+    return sample;
+}
+
+void apply_input_sample(InputManager& input, const InputSample& sample){
+    input.mouseScreenPosition = sample.mouseScreenPosition;
     input.keysLastFrame = input.keys;
-    input.keys[InputManager::LEFT]        = IsKeyDown(KEY_LEFT);
-    input.keys[InputManager::RIGHT]       = IsKeyDown(KEY_RIGHT);
-    input.keys[InputManager::DOWN]        = IsKeyDown(KEY_DOWN);
-    input.keys[InputManager::UP]          = IsKeyDown(KEY_UP);
-    input.keys[InputManager::PAUSE]       = IsKeyDown(KEY_ENTER);
-    input.keys[InputManager::RESET]       = IsKeyDown(KEY_R);
-    input.keys[InputManager::MOUSE_CLICK] = IsMouseButtonDown(MOUSE_BUTTON_LEFT);
+    input.keys = sample.keys;
+}
+
+void update_input(InputManager& input){
+    apply_input_sample(input, sample_input());
 }
 
 bool is_input_active(const InputManager& input, InputManager::Inputs check){
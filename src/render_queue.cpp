@@ -0,0 +1,122 @@
+#include"render_queue.h"
+#include<array>
+#include<limits>
+#include<stdexcept>
+
+void RenderQueue::clear(){
+    commands.clear();
+    sortEntries.clear();
+    particleQuads.clear();
+    sorted = true;
+}
+
+void RenderQueue::push(RenderLayer layer, const Command& command){
+    if(commands.size() >= std::numeric_limits<uint32_t>::max()){
+        throw std::length_error("Too many commands in render queue");
+    }
+    uint32_t commandIdx = (uint32_t)commands.size();
+    uint64_t key = ((uint64_t)layer << 56) | ((uint64_t)(command.texture.id & 0xFFFFFF) << 32) | commandIdx;
+    commands.push_back(command);
+    sortEntries.push_back(SortEntry{key, commandIdx});
+    sorted = false;
+}
+
+void RenderQueue::push_texture(RenderLayer layer, const Texture& texture, const Rectangle& source, const Rectangle& dest,
+                               const Vector2& origin, float rotation, Color tint){
+    push(layer, Command{
+        .type = Command::Type::TEXTURE,
+        .texture = texture,
+        .source = source,
+        .dest = dest,
+        .origin = origin,
+        .rotation = rotation,
+        .tint = tint,
+        .firstQuad = 0,
+        .quadCount = 0
+    });
+}
+
+void RenderQueue::push_sprite(const SpriteSheet& sprite, const SpriteTransform& transform, const Position& pos){
+    Rectangle source, dest;
+    Vector2 origin;
+    get_sprite_draw_rects(sprite, transform, pos, source, dest, origin);
+    push_texture(RenderLayer::SPRITES, sprite.texture, source, dest, origin, transform.rotation, WHITE);
+}
+
+void RenderQueue::push_particles(const ParticleGenerator& particles, const Position& pos){
+    size_t firstQuad = particleQuads.size();
+    particle_generator_write_quads(particles, pos, particleQuads);
+    if(particleQuads.size() >= std::numeric_limits<uint32_t>::max()){
+        throw std::length_error("Too many particles in render queue");
+    }
+    push(RenderLayer::PARTICLES, Command{
+        .type = Command::Type::PARTICLES,
+        .texture = particles.settings.texture,
+        .source = {0, 0, 0, 0},
+        .dest = {0, 0, 0, 0},
+        .origin = {0, 0},
+        .rotation = 0,
+        .tint = {0, 0, 0, 0},
+        .firstQuad = (uint32_t)firstQuad,
+        .quadCount = (uint32_t)(particleQuads.size() - firstQuad)
+    });
+}
+
+void RenderQueue::sort(){
+    if(sorted){
+        return;
+    }
+    sorted = true;
+    constexpr size_t KEY_BYTES = sizeof(uint64_t);
+    size_t n = sortEntries.size();
+    // histograms for every byte are built in one go
+    std::array<std::array<size_t, 256>, KEY_BYTES> counts{};
+    for(const SortEntry& entry : sortEntries){
+        for(size_t byte = 0; byte < KEY_BYTES; byte++){
+            counts[byte][(entry.key >> (byte * 8)) & 0xFF]++;
+        }
+    }
+    sortScratch.resize(n);
+    for(size_t byte = 0; byte < KEY_BYTES; byte++){
+        std::array<size_t, 256>& byteCounts = counts[byte];
+        // if every key has the same value for this byte, the pass wouldn't change anything
+        if(byteCounts[(sortEntries[0].key >> (byte * 8)) & 0xFF] == n){
+            continue;
+        }
+        size_t offset = 0;
+        for(size_t& count : byteCounts){
+            size_t bucketSize = count;
+            count = offset;
+            offset += bucketSize;
+        }
+        for(const SortEntry& entry : sortEntries){
+            sortScratch[byteCounts[(entry.key >> (byte * 8)) & 0xFF]++] = entry;
+        }
+        sortEntries.swap(sortScratch);
+    }
+}
+
+void RenderQueue::submit(){
+    lastStats = RenderStats{};
+    if(commands.empty()){
+        return;
+    }
+    sort();
+    unsigned int currentTexture = 0;
+    for(const SortEntry& entry : sortEntries){
+        const Command& command = commands[entry.commandIdx];
+        if(command.texture.id != currentTexture){
+            currentTexture = command.texture.id;
+            lastStats.textureBinds++;
+        }
+        switch(command.type){
+          case Command::Type::TEXTURE:
+            DrawTexturePro(command.texture, command.source, command.dest, command.origin, command.rotation, command.tint);
+            break;
+          case Command::Type::PARTICLES:
+            draw_particle_quads(command.texture, particleQuads.data() + command.firstQuad, command.quadCount);
+            break;
+        }
+    }
+    lastStats.commands = commands.size();
+}
@@ -1,40 +1,129 @@
 #include "rng_component.h"
+#include<algorithm>
 #include<ctime>
 
-RNGComponent new_rng_component(){
-    std::string seedString = "hello world";
-    unsigned int seed = *(unsigned int*)(&seedString);
-    return new_rng_component(seed);
+static inline uint32_t rotl(uint32_t x, int k){
+    return (x << k) | (x >> (32 - k));
+}
+
+// Steps every lane once, writing their outputs. Plain arithmetic on separate arrays (restrict parameters,
+// so the compiler knows they don't overlap), which the compiler turns into one step of all lanes at once.
+static void step_lanes(uint32_t* __restrict s0, uint32_t* __restrict s1, uint32_t* __restrict s2,
+                       uint32_t* __restrict s3, uint32_t* __restrict out){
+    for(size_t i = 0; i < RNG_LANES; i++){
+        out[i] = rotl(s1[i] * 5, 7) * 9;
+        uint32_t t = s1[i] << 9;
+        s2[i] ^= s0[i];
+        s3[i] ^= s1[i];
+        s1[i] ^= s2[i];
+        s0[i] ^= s3[i];
+        s2[i] ^= t;
+        s3[i] = rotl(s3[i], 11);
+    }
+}
+
+static inline void step_lanes(RNGComponent& rng, uint32_t* out){
+    step_lanes(rng.state[0], rng.state[1], rng.state[2], rng.state[3], out);
+}
+
+// Moves a single lane ahead by the number of steps encoded in the given polynomial (from the reference
+// xoshiro128** implementation).
+static void jump_lane(RNGComponent& rng, size_t lane, const uint32_t (&polynomial)[4]){
+    uint32_t s[4] = {rng.state[0][lane], rng.state[1][lane], rng.state[2][lane], rng.state[3][lane]};
+    uint32_t jumped[4] = {0, 0, 0, 0};
+    for(uint32_t word : polynomial){
+        for(int bit = 0; bit < 32; bit++){
+            if(word & (1u << bit)){
+                for(size_t i = 0; i < 4; i++){
+                    jumped[i] ^= s[i];
+                }
+            }
+            uint32_t t = s[1] << 9;
+            s[2] ^= s[0];
+            s[3] ^= s[1];
+            s[1] ^= s[2];
+            s[0] ^= s[3];
+            s[2] ^= t;
+            s[3] = rotl(s[3], 11);
+        }
+    }
+    for(size_t i = 0; i < 4; i++){
+        rng.state[i][lane] = jumped[i];
+    }
+}
+
+// Jumps 2^64 and 2^96 steps ahead, respectively
+static const uint32_t JUMP[4] = {0x8764000b, 0xf542d2d3, 0x6fa035c3, 0x77f2db5b};
+static const uint32_t LONG_JUMP[4] = {0xb523952e, 0x0b6f099f, 0xccf5a0ef, 0x1c580662};
+
+static uint64_t splitmix64(uint64_t& x){
+    uint64_t z = (x += 0x9e3779b97f4a7c15);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+    return z ^ (z >> 31);
 }
 
 RNGComponent new_rng_component_safe(){
-    unsigned int seed = time(nullptr);
-    return new_rng_component(seed);
+    return new_rng_component(time(nullptr));
 }
 
-RNGComponent new_rng_component(unsigned int seed){
-    return RNGComponent{
-        .intGenerator = std::minstd_rand(seed),
-        .floatGenerator = std::uniform_real_distribution<float>(0, 1)
-    };
+RNGComponent new_rng_component(uint64_t seed){
+    RNGComponent rng;
+    // the first lane's state comes from the seed, and every other lane is the previous one jumped ahead
+    uint64_t first = splitmix64(seed);
+    uint64_t second = splitmix64(seed);
+    rng.state[0][0] = (uint32_t)first;
+    rng.state[1][0] = (uint32_t)(first >> 32);
+    rng.state[2][0] = (uint32_t)second;
+    rng.state[3][0] = (uint32_t)(second >> 32);
+    for(size_t lane = 1; lane < RNG_LANES; lane++){
+        for(size_t i = 0; i < 4; i++){
+            rng.state[i][lane] = rng.state[i][lane - 1];
+        }
+        jump_lane(rng, lane, JUMP);
+    }
+    std::fill_n(rng.buffer, RNG_LANES, 0);
+    rng.bufferIndex = RNG_LANES;
+    return rng;
+}
+
+void rng_jump(RNGComponent& rng){
+    for(size_t lane = 0; lane < RNG_LANES; lane++){
+        jump_lane(rng, lane, LONG_JUMP);
+    }
+    rng.bufferIndex = RNG_LANES;
+}
+
+RNGComponent rng_split(RNGComponent& rng){
+    RNGComponent split = rng;
+    split.bufferIndex = RNG_LANES;
+    rng_jump(rng);
+    return split;
 }
 
 unsigned int random_int(RNGComponent& rng){
-    return rng.intGenerator();
+    if(rng.bufferIndex == RNG_LANES){
+        step_lanes(rng, rng.buffer);
+        rng.bufferIndex = 0;
+    }
+    return rng.buffer[rng.bufferIndex++];
 }
 
 unsigned int random_int(RNGComponent& rng, unsigned int upperBound){
-    unsigned int excess = (rng.intGenerator.max() + 1) % upperBound;
-    unsigned int rerollLimit = rng.intGenerator.max() - excess;
-    unsigned int output;
-    do{
-        output = rng.intGenerator();
-    } while(output > rerollLimit);
-    return output % upperBound;
+    uint64_t product = (uint64_t)random_int(rng) * upperBound;
+    uint32_t low = (uint32_t)product;
+    if(low < upperBound){
+        uint32_t rerollLimit = -upperBound % upperBound;
+        while(low < rerollLimit){
+            product = (uint64_t)random_int(rng) * upperBound;
+            low = (uint32_t)product;
+        }
+    }
+    return product >> 32;
 }
 
 unsigned int random_int_fast(RNGComponent& rng, unsigned int upperBound){
-    return rng.intGenerator() % upperBound;
+    return ((uint64_t)random_int(rng) * upperBound) >> 32;
 }
 
 unsigned int random_int(RNGComponent& rng, unsigned int lowerBound, unsigned int upperBound){
@@ -42,17 +131,56 @@ unsigned int random_int(RNGComponent& rng, unsigned int lowerBound, unsigned int
 }
 
 unsigned int random_int_fast(RNGComponent& rng, unsigned int lowerBound, unsigned int upperBound){
-    return lowerBound + rng.intGenerator() % (upperBound - lowerBound);
+    return lowerBound + random_int_fast(rng, upperBound - lowerBound);
+}
+
+// Turns a random integer into a float in [0, 1), from its top 24 bits (as many as a float's mantissa holds)
+static inline float to_unit_float(uint32_t x){
+    return (x >> 8) * (1.0f / 16777216.0f);
 }
 
 float random_float(RNGComponent& rng){
-    return rng.floatGenerator(rng.intGenerator);
+    return to_unit_float(random_int(rng));
 }
 
 float random_float(RNGComponent& rng, float upperBound){
-    return rng.floatGenerator(rng.intGenerator) * upperBound;
+    return random_float(rng) * upperBound;
 }
 
 float random_float(RNGComponent& rng, float lowerBound, float upperBound){
-    return (upperBound - lowerBound) * rng.floatGenerator(rng.intGenerator) + lowerBound;
-}
\ No newline at end of file
+    return (upperBound - lowerBound) * random_float(rng) + lowerBound;
+}
+
+void random_ints(RNGComponent& rng, unsigned int* out, size_t count){
+    size_t i = 0;
+    // first whatever is left from the last step, then whole steps straight into the output
+    for(; i < count && rng.bufferIndex < RNG_LANES; i++){
+        out[i] = rng.buffer[rng.bufferIndex++];
+    }
+    for(; i + RNG_LANES <= count; i += RNG_LANES){
+        step_lanes(rng, out + i);
+    }
+    for(; i < count; i++){
+        out[i] = random_int(rng);
+    }
+}
+
+// Number of floats generated per call to random_ints in random_floats
+static const size_t FLOAT_BATCH_SIZE = 16 * RNG_LANES;
+
+void random_floats(RNGComponent& rng, float* out, size_t count){
+    random_floats(rng, out, count, 0.f, 1.f);
+}
+
+void random_floats(RNGComponent& rng, float* out, size_t count, float lowerBound, float upperBound){
+    unsigned int ints[FLOAT_BATCH_SIZE];
+    float range = upperBound - lowerBound;
+    for(size_t begin = 0; begin < count; begin += FLOAT_BATCH_SIZE){
+        size_t batchSize = std::min(FLOAT_BATCH_SIZE, count - begin);
+        random_ints(rng, ints, batchSize);
+        float* batchOut = out + begin;
+        for(size_t i = 0; i < batchSize; i++){
+            batchOut[i] = range * to_unit_float(ints[i]) + lowerBound;
+        }
+    }
+}
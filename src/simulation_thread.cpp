@@ -0,0 +1,116 @@
+#include"simulation_thread.h"
+#include"job_system.h"
+#include<utility>
+
+SimulationThread::SimulationThread(LevelSequence& levels) : levels(levels) {}
+
+SimulationThread::~SimulationThread(){
+    try {
+        stop();
+    } catch(...) {}
+}
+
+void SimulationThread::start(){
+    if(thread.joinable()){
+        return;
+    }
+    // the first frame is written right away, so there's something to draw while the first update runs
+    write_frame();
+    stopRequested = false;
+    exited = false;
+    thread = std::thread([this]{ run(); });
+}
+
+void SimulationThread::push_command(Command command){
+    std::lock_guard<std::mutex> lock(mutex);
+    pendingCommands.push_back(std::move(command));
+}
+
+void SimulationThread::request_update(float delta){
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        pendingDelta += delta;
+        pendingUpdate = true;
+    }
+    updateRequested.notify_one();
+}
+
+void SimulationThread::run(){
+    std::vector<Command> commands;
+    try {
+        while(true){
+            float delta;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                updateRequested.wait(lock, [this]{ return stopRequested || pendingUpdate; });
+                if(stopRequested){
+                    break;
+                }
+                delta = pendingDelta;
+                pendingDelta = 0;
+                pendingUpdate = false;
+                commands.swap(pendingCommands);
+            }
+            for(Command& command : commands){
+                command(levels);
+            }
+            commands.clear();
+
+            // levels are only destroyed once the main thread has stopped drawing them, since their
+            // snapshots reference their textures
+            levels.release_finished_levels(drawnLevelIdx.load(std::memory_order_acquire));
+            levels.update(delta);
+            if(levels.is_finished()){
+                finished.store(true, std::memory_order_release);
+                break;
+            }
+            write_frame();
+        }
+    } catch(...) {
+        exception = std::current_exception();
+        finished.store(true, std::memory_order_release);
+    }
+    exited.store(true, std::memory_order_release);
+}
+
+void SimulationThread::write_frame(){
+    FrameSnapshot& frame = frames.write_buffer();
+    levels.current().write_frame_snapshot(frame);
+    frame.levelIdx = levels.current_level_index();
+    frames.publish();
+}
+
+void SimulationThread::draw(bool debugMode){
+    if(frames.update_read_buffer()){
+        hasFrame = true;
+        drawnLevelIdx.store(frames.read_buffer().levelIdx, std::memory_order_release);
+    }
+    if(!hasFrame){
+        BeginDrawing();
+            ClearBackground(DARKGRAY);
+        EndDrawing();
+        return;
+    }
+    draw_frame_snapshot(frames.read_buffer(), debugMode);
+}
+
+void SimulationThread::stop(){
+    if(!thread.joinable()){
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopRequested = true;
+    }
+    updateRequested.notify_one();
+    // the simulation thread might be waiting for the main thread (to bake tilemaps, upload textures,...)
+    while(!exited.load(std::memory_order_acquire)){
+        JobSystem::process_main_thread_jobs();
+        std::this_thread::yield();
+    }
+    thread.join();
+    if(exception){
+        std::exception_ptr thrown = std::exchange(exception, nullptr);
+        std::rethrow_exception(thrown);
+    }
+}
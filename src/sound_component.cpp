@@ -1,16 +1,13 @@
 #include "sound_component.h"
-#include "sound_handle.h"
 #include "sound_loader.h"
+#include "voice_pool.h"
 #include <algorithm>
 #include <cstddef>
 #include <cstring>
-
-SoundKey operator""_sound(const char* str, size_t str_size){
-    return std::hash<std::string>()({str, str_size});
-}
+#include <utility>
 
 SoundKey to_key(const std::string& str){
-    return std::hash<std::string>()(str);
+    return util::hash_string(str);
 }
 
 SoundKey to_key(const char* str){
@@ -23,15 +20,48 @@ SoundComponent::SoundComponent() : sounds{}, keys{} {
     keys.reserve(DEFAULT_CAPACITY);
 }
 
+SoundComponent::SoundComponent(const SoundComponent& other) : sounds{}, keys{other.keys}, priority{other.priority} {
+    sounds.reserve(other.sounds.size());
+    for(SoundId id : other.sounds){
+        sounds.push_back(SoundLoader::get_sound_copy(id));
+    }
+}
+
+SoundComponent::SoundComponent(SoundComponent&& other) : sounds{std::move(other.sounds)}, keys{std::move(other.keys)}, priority{other.priority} {
+    other.sounds.clear();
+    other.keys.clear();
+}
+
+SoundComponent& SoundComponent::operator=(const SoundComponent& other){
+    if(this != &other){
+        SoundComponent copy{other};
+        *this = std::move(copy);
+    }
+    return *this;
+}
+
+SoundComponent& SoundComponent::operator=(SoundComponent&& other){
+    if(this != &other){
+        for(SoundId id : sounds){
+            SoundLoader::return_sound(id);
+        }
+        sounds = std::move(other.sounds);
+        keys = std::move(other.keys);
+        priority = other.priority;
+        other.sounds.clear();
+        other.keys.clear();
+    }
+    return *this;
+}
+
 SoundComponent::~SoundComponent(){
-    for(SoundHandle& sound : sounds) {
-        SoundLoader::return_sound(sound);
+    for(SoundId id : sounds){
+        SoundLoader::return_sound(id);
     }
 }
 
 void add_sound_to_component(SoundComponent& sound, const char* soundFilename, SoundKey key){
-    SoundHandle loadedSound = SoundLoader::load_or_get_sound(soundFilename);
-    sound.sounds.push_back(loadedSound);
+    sound.sounds.push_back(SoundLoader::load_or_get_sound(soundFilename));
     sound.keys.push_back(key);
 }
 
@@ -39,20 +69,34 @@ void remove_sound_from_component(SoundComponent& sound, SoundKey key){
     auto itr = std::find(sound.keys.begin(), sound.keys.end(), key);
     if(itr != sound.keys.end()){
         size_t idx = itr - sound.keys.begin();
-        auto sound_itr = sound.sounds.begin() + idx;
-        sound.sounds.erase(sound_itr);
+        SoundId id = sound.sounds[idx];
+        sound.sounds.erase(sound.sounds.begin() + idx);
         sound.keys.erase(itr);
+        SoundLoader::return_sound(id);
     }
 }
 
-void try_play_sound(SoundComponent& sound, SoundKey key){
+// Plays the sound with the given key, if the component has it, with the component's priority.
+static void play_sound_by_key(const SoundComponent& sound, SoundKey key, VoicePool::PlayParams& params){
     auto itr = std::find(sound.keys.begin(), sound.keys.end(), key);
     if(itr != sound.keys.end()){
-        size_t idx = itr - sound.keys.begin();
-        sound.sounds[idx].play();
+        params.priority = sound.priority;
+        VoicePool::play(sound.sounds[itr - sound.keys.begin()], params);
     }
 }
 
+void try_play_sound(const SoundComponent& sound, SoundKey key){
+    VoicePool::PlayParams params;
+    play_sound_by_key(sound, key, params);
+}
+
+void try_play_sound(const SoundComponent& sound, SoundKey key, Vector2 position){
+    VoicePool::PlayParams params;
+    params.isPositional = true;
+    params.position = position;
+    play_sound_by_key(sound, key, params);
+}
+
 bool has_sound(const SoundComponent& sound, SoundKey key){
     return std::find(sound.keys.begin(), sound.keys.end(), key) != sound.keys.end();
 }
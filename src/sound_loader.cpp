@@ -1,61 +1,59 @@
 #include "sound_loader.h"
-#include "sound_handle.h"
-#include <cassert>
-#include <algorithm>
+#include "voice_pool.h"
+#include "asset_files.h"
 #include <cstddef>
+#include <optional>
 #include <stdexcept>
-#include <utility>
 
 namespace SoundLoader {
 
-SoundInfo::SoundInfo(const char* filepath) : refCount(1), sound(filepath) {};
-
-SoundHandle load_or_get_sound(const char* filepath){
-    auto itr = _soundFileMap.find(filepath);
-    if(itr != _soundFileMap.end()){
-        SoundInfo& soundInfo = itr->second;
-        soundInfo.refCount++;
-        return SoundHandle{soundInfo.sound};
-    } else {
-        SoundInfo soundInfo{filepath};
-        _soundFileMap.emplace(std::make_pair(filepath, std::move(soundInfo)));
-        return SoundHandle{soundInfo.sound};
+SoundId load_or_get_sound(const char* filepath){
+    SoundId id = _sounds.acquire(filepath);
+    if(!id.is_valid()){
+        // another thread might load the same file in the meantime, in which case this one is unloaded
+        AssetFiles::AssetWave wave = AssetFiles::load_wave(filepath);
+        Sound sound = IsWaveValid(wave.wave) ? LoadSoundFromWave(wave.wave) : Sound{};
+        AssetFiles::unload_wave(wave);
+        id = register_loaded_sound(filepath, sound);
     }
+    return id;
 }
 
-void return_sound(SoundHandle& sound){
-    auto itr = std::find_if(_soundFileMap.begin(), _soundFileMap.end(), [&sound](const std::pair<const std::string, SoundInfo>& pair){
-        return pair.second.sound == sound;
-    });
-
-    if(itr != _soundFileMap.end()){
-        itr->second.refCount--;
-        if(itr->second.refCount == 0){
-            _soundFileMap.erase(itr);
-        }
+SoundId register_loaded_sound(const char* filepath, Sound sound){
+    auto [id, inserted] = _sounds.insert(filepath, sound);
+    if(!inserted){
+        UnloadSound(sound);
     }
+    return id;
 }
 
-SoundHandle get_sound_copy(const SoundHandle& sound){
-    auto itr = std::find_if(_soundFileMap.begin(), _soundFileMap.end(), [&sound](const std::pair<const std::string, SoundInfo>& pair){
-        return pair.second.sound == sound;
-    });
+void return_sound(SoundId sound){
+    std::optional<Sound> unloaded = _sounds.release(sound);
+    if(unloaded){
+        // the voices' aliases of the sound share its buffer, so they go first
+        VoicePool::stop_sound(sound);
+        UnloadSound(*unloaded);
+    }
+}
 
-    if(itr != _soundFileMap.end()){
-        itr->second.refCount++;
-        return SoundHandle{itr->second.sound};
-    } else {
-        throw new std::invalid_argument("Copying sound not registered by SoundLoader");
+SoundId get_sound_copy(SoundId sound){
+    if(!sound.is_valid()){
+        throw std::invalid_argument("Copying sound not registered by SoundLoader");
     }
+    _sounds.acquire(sound);
+    return sound;
+}
+
+std::optional<Sound> get_sound(SoundId sound){
+    return _sounds.try_get(sound);
 }
 
 size_t _get_sound_ref_count(const char* filepath){
-    auto iter = _soundFileMap.find(filepath);
-    if(iter != _soundFileMap.end()){
-        return iter->second.refCount;
-    } else {
-        return 0;
-    }
+    return _sounds.get_ref_count(filepath);
+}
+
+AssetStats get_sound_stats(){
+    return _sounds.stats();
 }
 
 } // namespace SoundLoader
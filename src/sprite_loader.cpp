@@ -1,75 +1,143 @@
 #include"sprite_loader.h"
+#include"asset_files.h"
+#include"job_system.h"
+#include<iterator>
+#include<mutex>
+#include<optional>
 #include<stdexcept>
-#include<algorithm>
+#include<string>
+#include<unordered_map>
 
-#include<iostream>
+namespace {
+    // (private) Area of an atlas page holding a packed image
+    struct AtlasRegion {
+        TextureId page;
+        Rectangle area;
+    };
+    // Atlas regions by the filepath of the image packed in them. A region whose page has been unloaded
+    // is stale (its id no longer resolves), and gets erased when the page is.
+    std::unordered_map<std::string, AtlasRegion> atlasRegions;
+    std::mutex atlasRegionsMutex;
+}
+
+Texture SpriteLoader::load_texture_from_any_thread(const char* filepath){
+    AssetFiles::AssetImage image = AssetFiles::load_image(filepath);
+    Texture texture = load_texture_from_image_any_thread(image.image);
+    AssetFiles::unload_image(image);
+    return texture;
+}
 
-SpriteLoader::TextureInfo::TextureInfo(const char* filepath) : texture(LoadTexture(filepath)), refCount(1), unloadOnDestruct(false) {}
-SpriteLoader::TextureInfo::~TextureInfo(){
-    if(unloadOnDestruct){
-        if(refCount > 0) throw std::runtime_error("Unloading a texture with ref count greater than zero");
+void SpriteLoader::unload_texture_from_any_thread(Texture texture){
+    if(JobSystem::is_main_thread()){
         UnloadTexture(texture);
+    } else {
+        JobSystem::run_on_main_thread([texture]{ UnloadTexture(texture); });
     }
 }
 
-Texture SpriteLoader::load_new_texture_always(const char* filepath){
-    std::string uniqueFileName(filepath);
-    TextureInfo texture{filepath};
-    while(_spriteFileMap.find(uniqueFileName) != _spriteFileMap.end()){
-        uniqueFileName += '_';
+Texture SpriteLoader::load_texture_from_image_any_thread(const Image& image){
+    if(JobSystem::is_main_thread()){
+        return LoadTextureFromImage(image);
     }
-    _spriteFileMap.emplace(uniqueFileName, std::move(texture));
-    _spriteFileMap[uniqueFileName].unloadOnDestruct = true;
-    return texture.texture;
+    return JobSystem::run_on_main_thread_and_wait([&image]{ return LoadTextureFromImage(image); });
+}
+
+// NOTE: textures are always loaded and unloaded outside of the registry's lock, since loading on a
+// worker thread waits for the main thread, which might be waiting for the lock itself.
+
+Texture SpriteLoader::load_new_texture_always(const char* filepath){
+    Texture texture = load_texture_from_any_thread(filepath);
+    _textures.insert_unique(filepath, texture);
+    return texture;
 }
 
 Texture SpriteLoader::load_or_get_texture(const char* filepath){
-    auto itr = _spriteFileMap.find(filepath);
-    if(itr != _spriteFileMap.end()){
-        itr->second.refCount++;
-        return itr->second.texture;
-    } else {
-        TextureInfo textureInfo{filepath};
-        _spriteFileMap.emplace(filepath, std::move(textureInfo));
-        _spriteFileMap[filepath].unloadOnDestruct = true;
-        return textureInfo.texture;
+    TextureId id = _textures.acquire(filepath);
+    if(id.is_valid()){
+        return _textures.get(id);
+    }
+    // another thread might load the same file in the meantime, in which case this one is unloaded
+    return register_loaded_texture(filepath, load_texture_from_any_thread(filepath));
+}
+
+Texture SpriteLoader::register_loaded_texture(const char* filepath, Texture texture){
+    auto [id, inserted] = _textures.insert(filepath, texture);
+    if(!inserted){
+        unload_texture_from_any_thread(texture);
+        return _textures.get(id);
     }
+    return texture;
+}
+
+Texture SpriteLoader::register_texture(const char* name, Texture texture, size_t refCount){
+    _textures.insert_unique(name, texture, refCount);
+    return texture;
 }
 
-static bool operator==(const Texture& texture1, const Texture& texture2){
-    return (texture1.id == texture2.id);
+void SpriteLoader::register_atlas_region(const char* filepath, Texture page, Rectangle area){
+    TextureId pageId = _textures.find_by_asset(page);
+    std::lock_guard<std::mutex> lock(atlasRegionsMutex);
+    atlasRegions[filepath] = AtlasRegion{pageId, area};
+}
+
+bool SpriteLoader::has_atlas_region(const char* filepath){
+    std::lock_guard<std::mutex> lock(atlasRegionsMutex);
+    auto iter = atlasRegions.find(filepath);
+    return iter != atlasRegions.end() && _textures.try_get(iter->second.page).has_value();
+}
+
+SpriteLoader::TextureRegion SpriteLoader::load_or_get_texture_region(const char* filepath){
+    {
+        std::lock_guard<std::mutex> lock(atlasRegionsMutex);
+        auto iter = atlasRegions.find(filepath);
+        // the page can't be unloaded while the lock is held (return_texture takes it first)
+        if(iter != atlasRegions.end() && _textures.try_get(iter->second.page).has_value()){
+            return TextureRegion{_textures.acquire(iter->second.page), iter->second.area};
+        }
+    }
+    Texture texture = load_or_get_texture(filepath);
+    return TextureRegion{texture, Rectangle{0, 0, (float)texture.width, (float)texture.height}};
 }
 
 void SpriteLoader::return_texture(Texture texture){
-    auto iter = std::find_if(_spriteFileMap.begin(), _spriteFileMap.end(), [&texture](const std::pair<const std::string, TextureInfo>& pair){
-        return pair.second.texture == texture;
-    });
-
-    if(iter != _spriteFileMap.end()){
-        iter->second.refCount--;
-        if(iter->second.refCount == 0){
-            _spriteFileMap.erase(iter);
+    TextureId id = _textures.find_by_asset(texture);
+    std::optional<Texture> unloaded;
+    {
+        // held while releasing, so that load_or_get_texture_region never acquires a page being unloaded
+        std::lock_guard<std::mutex> lock(atlasRegionsMutex);
+        unloaded = _textures.release(id);
+        if(unloaded){
+            for(auto iter = atlasRegions.begin(); iter != atlasRegions.end();){
+                iter = (iter->second.page == id) ? atlasRegions.erase(iter) : std::next(iter);
+            }
         }
     }
+    if(unloaded){
+        unload_texture_from_any_thread(*unloaded);
+    }
 }
 
 Texture SpriteLoader::get_texture_copy(Texture texture){
-    auto iter = std::find_if(_spriteFileMap.begin(), _spriteFileMap.end(), [&texture](const std::pair<const std::string, TextureInfo>& pair){
-        return pair.second.texture == texture;
-    });
-    if(iter != _spriteFileMap.end()){
-        iter->second.refCount++;
-        return texture;
-    } else {
+    TextureId id = _textures.find_by_asset(texture);
+    if(!id.is_valid()){
         throw std::invalid_argument("Copying texture not registered by SpriteLoader");
     }
+    _textures.acquire(id);
+    return texture;
+}
+
+TextureId SpriteLoader::get_texture_id(Texture texture){
+    return _textures.find_by_asset(texture);
+}
+
+std::string SpriteLoader::get_texture_name(Texture texture){
+    return _textures.get_name(_textures.find_by_asset(texture));
 }
 
 size_t SpriteLoader::_get_texture_ref_count(const char* filepath){
-    auto iter = _spriteFileMap.find(filepath);
-    if(iter != _spriteFileMap.end()){
-        return iter->second.refCount;
-    } else {
-        return 0;
-    }
+    return _textures.get_ref_count(filepath);
+}
+
+AssetStats SpriteLoader::get_texture_stats(){
+    return _textures.stats();
 }
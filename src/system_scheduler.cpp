@@ -0,0 +1,58 @@
+#include "system_scheduler.h"
+#include "job_system.h"
+#include <algorithm>
+#include <utility>
+
+void SystemScheduler::add_system_info(SystemInfo&& info){
+    systems.push_back(std::move(info));
+    graphOutdated = true;
+}
+
+bool SystemScheduler::conflicting(const SystemInfo& system1, const SystemInfo& system2) const {
+    auto intersects = [](const std::vector<entt::id_type>& ids1, const std::vector<entt::id_type>& ids2){
+        return std::any_of(ids1.begin(), ids1.end(), [&ids2](entt::id_type id){
+            return std::find(ids2.begin(), ids2.end(), id) != ids2.end();
+        });
+    };
+    return intersects(system1.writes, system2.writes)
+        || intersects(system1.writes, system2.reads)
+        || intersects(system1.reads, system2.writes);
+}
+
+void SystemScheduler::build_graph(){
+    size_t numberSystems = systems.size();
+    dependents.assign(numberSystems, {});
+    // Conflicting systems are ordered by insertion order, so every edge goes from an earlier
+    // system to a later one and the graph can't have cycles.
+    for(size_t j = 0; j < numberSystems; j++){
+        for(size_t i = 0; i < j; i++){
+            if(conflicting(systems[i], systems[j])){
+                dependents[i].push_back(j);
+            }
+        }
+    }
+    graphOutdated = false;
+}
+
+void SystemScheduler::run(LevelRegistry& level, float delta){
+    if(graphOutdated){
+        build_graph();
+    }
+    const size_t numberSystems = systems.size();
+    std::vector<JobSystem::TaskHandle> tasks;
+    tasks.reserve(numberSystems);
+    for(size_t i = 0; i < numberSystems; i++){
+        SystemFunction function = systems[i].function;
+        tasks.push_back(JobSystem::create_task([function, &level, delta]{ function(level, delta); }, systems[i].mainThreadOnly));
+    }
+    for(size_t i = 0; i < numberSystems; i++){
+        for(size_t dependent : dependents[i]){
+            JobSystem::add_dependency(tasks[dependent], tasks[i]);
+        }
+    }
+    for(const JobSystem::TaskHandle& task : tasks){
+        JobSystem::submit(task);
+    }
+    // the main thread runs the main-thread-only systems and helps with the rest while it waits
+    JobSystem::wait_all(tasks);
+}
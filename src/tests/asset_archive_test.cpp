@@ -0,0 +1,146 @@
+// Packs the resources directory with the asset_pack tool (as is and pre-decoded), then checks that every file
+// read through AssetFiles from the archive matches the loose file, and that archives with corrupt entries are
+// rejected. Run from the repository root, after `make asset_pack`.
+#include<raylib.h>
+#include"asset_archive.h"
+#include"asset_files.h"
+#include"test_checks.h"
+#include<cstdint>
+#include<cstdlib>
+#include<cstring>
+#include<filesystem>
+#include<fstream>
+#include<iostream>
+#include<iterator>
+#include<string>
+#include<vector>
+
+namespace fs = std::filesystem;
+
+static const char* ARCHIVE_FILENAME = "bin/asset_archive_test.pak";
+static const char* CORRUPT_ARCHIVE_FILENAME = "bin/asset_archive_test_corrupt.pak";
+static const char* PACKED_DIRECTORY = "resources";
+
+static std::vector<std::string> list_packed_files(){
+    std::vector<std::string> paths;
+    for(const fs::directory_entry& entry : fs::recursive_directory_iterator(PACKED_DIRECTORY)){
+        if(entry.is_regular_file()){
+            paths.push_back(entry.path().generic_string());
+        }
+    }
+    return paths;
+}
+
+static bool pack(bool decode){
+    std::string command = std::string("bin/asset_pack ") + (decode ? "--decode " : "") + ARCHIVE_FILENAME + " " + PACKED_DIRECTORY;
+    return std::system(command.c_str()) == 0;
+}
+
+static bool same_image(const Image& a, const Image& b){
+    return a.width == b.width && a.height == b.height &&
+           std::memcmp(a.data, b.data, (size_t)a.width * a.height * 4) == 0;
+}
+
+static bool same_wave(const Wave& a, const Wave& b){
+    return a.frameCount == b.frameCount && a.sampleRate == b.sampleRate && a.sampleSize == b.sampleSize && a.channels == b.channels &&
+           std::memcmp(a.data, b.data, (size_t)a.frameCount * a.channels * (a.sampleSize / 8)) == 0;
+}
+
+// Checks every file read from the mounted archive against the loose file.
+static void check_archive_contents(const std::vector<std::string>& paths){
+    for(const std::string& path : paths){
+        const char* filepath = path.c_str();
+        const ArchiveEntry* entry = AssetFiles::_archive.find(path);
+        CHECK(entry != nullptr, "'" << path << "' is in the archive");
+        if(entry == nullptr){
+            continue;
+        }
+        if(entry->type == ArchiveEntryType::FILE){
+            std::string packed;
+            std::ifstream file(path, std::ios::binary);
+            std::string loose{std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+            CHECK(AssetFiles::load_file(filepath, packed) && packed == loose, "'" << path << "' matches the loose file");
+        } else if(entry->type == ArchiveEntryType::IMAGE_RGBA8){
+            Image loose = LoadImage(filepath);
+            ImageFormat(&loose, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+            AssetFiles::AssetImage packed = AssetFiles::load_image(filepath);
+            CHECK(!packed.ownsData && same_image(packed.image, loose), "'" << path << "' has the loose file's pixels");
+            AssetFiles::unload_image(packed);
+            UnloadImage(loose);
+        } else if(entry->type == ArchiveEntryType::WAVE_PCM){
+            Wave loose = LoadWave(filepath);
+            AssetFiles::AssetWave packed = AssetFiles::load_wave(filepath);
+            CHECK(!packed.ownsData && same_wave(packed.wave, loose), "'" << path << "' has the loose file's samples");
+            AssetFiles::unload_wave(packed);
+            UnloadWave(loose);
+        }
+    }
+}
+
+// Writes a copy of the archive with the first entry of the given type changed by `corrupt`, and checks
+// that it can't be opened.
+template<class Corruption>
+static void check_rejected(const std::vector<char>& archive, ArchiveEntryType type, const char* what, Corruption corrupt){
+    std::vector<char> bytes = archive;
+    ArchiveHeader header;
+    std::memcpy(&header, bytes.data(), sizeof(header));
+    for(uint32_t i = 0; i < header.entryCount; i++){
+        char* entryBytes = bytes.data() + header.entriesOffset + i * sizeof(ArchiveEntry);
+        ArchiveEntry entry;
+        std::memcpy(&entry, entryBytes, sizeof(entry));
+        if(entry.type != type){
+            continue;
+        }
+        corrupt(entry);
+        std::memcpy(entryBytes, &entry, sizeof(entry));
+        std::ofstream(CORRUPT_ARCHIVE_FILENAME, std::ios::binary).write(bytes.data(), bytes.size());
+        AssetArchive corruptArchive;
+        CHECK(!corruptArchive.open(CORRUPT_ARCHIVE_FILENAME), "archive with " << what << " is rejected");
+        return;
+    }
+    std::cerr << "SKIPPED: no entry to test " << what << " with\n";
+}
+
+int main(){
+    SetTraceLogLevel(LOG_WARNING);
+    fs::create_directories("bin");
+    std::vector<std::string> paths = list_packed_files();
+
+    for(bool decode : {false, true}){
+        std::cout << "Packing '" << PACKED_DIRECTORY << "'" << (decode ? " decoded" : "") << '\n';
+        CHECK(pack(decode), "asset_pack succeeds");
+        CHECK(AssetFiles::mount_archive(ARCHIVE_FILENAME), "the archive can be mounted");
+        CHECK(AssetFiles::_archive.size() == paths.size(), "the archive has every file");
+        check_archive_contents(paths);
+        AssetFiles::unmount_archive();
+    }
+
+    // the decoded archive is left in ARCHIVE_FILENAME
+    std::ifstream file(ARCHIVE_FILENAME, std::ios::binary);
+    std::vector<char> archive{std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+    for(ArchiveEntryType type : {ArchiveEntryType::FILE, ArchiveEntryType::IMAGE_RGBA8, ArchiveEntryType::WAVE_PCM}){
+        check_rejected(archive, type, "a payload past the end of the file", [&](ArchiveEntry& entry){
+            entry.dataSize = archive.size();
+        });
+        check_rejected(archive, type, "a payload offset + size that wraps around", [](ArchiveEntry& entry){
+            entry.dataOffset = UINT64_MAX - 16;
+            entry.dataSize = 64;
+        });
+    }
+    check_rejected(archive, ArchiveEntryType::IMAGE_RGBA8, "an image larger than its payload", [](ArchiveEntry& entry){
+        entry.info[1]++;
+    });
+    check_rejected(archive, ArchiveEntryType::IMAGE_RGBA8, "an image size that wraps around", [](ArchiveEntry& entry){
+        entry.info[0] = 0x40000000;
+        entry.info[1] = 0x40000000;
+    });
+    check_rejected(archive, ArchiveEntryType::WAVE_PCM, "a wave longer than its payload", [](ArchiveEntry& entry){
+        entry.info[0]++;
+    });
+    check_rejected(archive, ArchiveEntryType::WAVE_PCM, "an invalid sample size", [](ArchiveEntry& entry){
+        entry.info[2] = 12;
+    });
+    fs::remove(CORRUPT_ARCHIVE_FILENAME);
+
+    return finish_checks();
+}
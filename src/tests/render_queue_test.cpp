@@ -0,0 +1,87 @@
+// Checks that the RenderQueue's radix sort puts commands in the same order as a stable sort by layer, then
+// texture: with texture ids spanning several key bytes, with keys that share every byte but the order of
+// submission, and when commands are pushed after a sort or after clear(). Only sorts, so no window is needed.
+#include<raylib.h>
+#include"render_queue.h"
+#include"test_checks.h"
+#include<algorithm>
+#include<cstdlib>
+#include<vector>
+
+struct Pushed {
+    RenderLayer layer;
+    unsigned int textureId;
+};
+
+// Pushes a command tagged with its index in `pushed` (as dest.x), so that its place can be checked after sorting.
+static void push(RenderQueue& queue, std::vector<Pushed>& pushed, RenderLayer layer, unsigned int textureId){
+    Texture texture{textureId, 16, 16, 1, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8};
+    queue.push_texture(layer, texture, Rectangle{0, 0, 16, 16}, Rectangle{(float)pushed.size(), 0, 16, 16});
+    pushed.push_back(Pushed{layer, textureId});
+}
+
+static bool is_sorted_like_stable_sort(RenderQueue& queue, const std::vector<Pushed>& pushed){
+    std::vector<size_t> expected(pushed.size());
+    for(size_t i = 0; i < expected.size(); i++){
+        expected[i] = i;
+    }
+    std::stable_sort(expected.begin(), expected.end(), [&pushed](size_t a, size_t b){
+        if(pushed[a].layer != pushed[b].layer){
+            return pushed[a].layer < pushed[b].layer;
+        }
+        return pushed[a].textureId < pushed[b].textureId;
+    });
+    std::vector<size_t> actual;
+    queue.for_each_command([&actual](const RenderQueue::Command& command){
+        actual.push_back((size_t)command.dest.x);
+    });
+    return actual == expected;
+}
+
+static void check_random_keys(){
+    const unsigned int textureIds[] = {1, 2, 3, 255, 256, 257, 65535, 65536, 70000, 0xFFFFFF};
+    RenderQueue queue;
+    std::vector<Pushed> pushed;
+    std::srand(3);
+    for(size_t i = 0; i < 5000; i++){
+        push(queue, pushed, (RenderLayer)(std::rand() % 3), textureIds[std::rand() % 10]);
+    }
+    CHECK(is_sorted_like_stable_sort(queue, pushed), "commands with random layers and textures are sorted");
+
+    // pushing after a sort makes the queue sort again
+    for(size_t i = 0; i < 100; i++){
+        push(queue, pushed, (RenderLayer)(std::rand() % 3), textureIds[std::rand() % 10]);
+    }
+    CHECK(queue.size() == pushed.size(), "every command is queued");
+    CHECK(is_sorted_like_stable_sort(queue, pushed), "commands pushed after a sort are sorted");
+
+    queue.clear();
+    pushed.clear();
+    CHECK(is_sorted_like_stable_sort(queue, pushed), "an empty queue is sorted");
+    for(size_t i = 0; i < 300; i++){
+        push(queue, pushed, RenderLayer::TILEMAPS, 300 - i);
+    }
+    CHECK(is_sorted_like_stable_sort(queue, pushed), "commands pushed after clear() are sorted");
+}
+
+static void check_shared_bytes(){
+    // the layer and texture bytes are the same for every key, so those passes are skipped
+    RenderQueue queue;
+    std::vector<Pushed> pushed;
+    for(size_t i = 0; i < 1000; i++){
+        push(queue, pushed, RenderLayer::PARTICLES, 42);
+    }
+    CHECK(is_sorted_like_stable_sort(queue, pushed), "commands sharing a layer and texture keep the order they were pushed in");
+
+    RenderQueue single;
+    std::vector<Pushed> singlePushed;
+    push(single, singlePushed, RenderLayer::SPRITES, 7);
+    CHECK(is_sorted_like_stable_sort(single, singlePushed), "a single command is sorted");
+}
+
+int main(){
+    check_random_keys();
+    check_shared_bytes();
+
+    return finish_checks();
+}
@@ -0,0 +1,208 @@
+// Checks the RNGComponent against a scalar xoshiro128** (the reference implementation): that its lanes and
+// jumps are the reference ones, that the batch functions give exactly what the single calls would from any
+// point of the buffer, that bounded ints stay below their bound without the multiply-shift bias, and that
+// split streams don't share any output.
+#include"rng_component.h"
+#include"test_checks.h"
+#include<cstdint>
+#include<unordered_set>
+#include<vector>
+
+// The reference xoshiro128**, on a single state
+
+static inline uint32_t rotl(uint32_t x, int k){
+    return (x << k) | (x >> (32 - k));
+}
+
+static uint32_t reference_next(uint32_t (&s)[4]){
+    uint32_t result = rotl(s[1] * 5, 7) * 9;
+    uint32_t t = s[1] << 9;
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = rotl(s[3], 11);
+    return result;
+}
+
+static void reference_jump(uint32_t (&s)[4], const uint32_t (&polynomial)[4]){
+    uint32_t jumped[4] = {0, 0, 0, 0};
+    for(uint32_t word : polynomial){
+        for(int bit = 0; bit < 32; bit++){
+            if(word & (1u << bit)){
+                for(size_t i = 0; i < 4; i++){
+                    jumped[i] ^= s[i];
+                }
+            }
+            reference_next(s);
+        }
+    }
+    for(size_t i = 0; i < 4; i++){
+        s[i] = jumped[i];
+    }
+}
+
+static const uint32_t JUMP[4] = {0x8764000b, 0xf542d2d3, 0x6fa035c3, 0x77f2db5b};
+static const uint32_t LONG_JUMP[4] = {0xb523952e, 0x0b6f099f, 0xccf5a0ef, 0x1c580662};
+
+static void get_lane(const RNGComponent& rng, size_t lane, uint32_t (&s)[4]){
+    for(size_t i = 0; i < 4; i++){
+        s[i] = rng.state[i][lane];
+    }
+}
+
+static bool same_lane(const RNGComponent& rng, size_t lane, const uint32_t (&s)[4]){
+    uint32_t actual[4];
+    get_lane(rng, lane, actual);
+    return actual[0] == s[0] && actual[1] == s[1] && actual[2] == s[2] && actual[3] == s[3];
+}
+
+// Every lane starts 2^64 steps after the previous one, and outputs are taken from the lanes in order.
+static void check_reference_stream(){
+    RNGComponent rng = new_rng_component(1234);
+    uint32_t lanes[RNG_LANES][4];
+    get_lane(rng, 0, lanes[0]);
+    for(size_t lane = 1; lane < RNG_LANES; lane++){
+        for(size_t i = 0; i < 4; i++){
+            lanes[lane][i] = lanes[lane - 1][i];
+        }
+        reference_jump(lanes[lane], JUMP);
+        CHECK(same_lane(rng, lane, lanes[lane]), "lane " << lane << " is 2^64 steps after lane " << lane - 1);
+    }
+    for(size_t step = 0; step < 100; step++){
+        for(size_t lane = 0; lane < RNG_LANES; lane++){
+            uint32_t expected = reference_next(lanes[lane]);
+            CHECK(random_int(rng) == expected, "output " << step * RNG_LANES + lane << " is the reference one");
+        }
+    }
+
+    // whatever is left in the buffer, a jump is the reference long jump of every lane
+    random_int(rng);
+    rng_jump(rng);
+    for(size_t lane = 0; lane < RNG_LANES; lane++){
+        reference_next(lanes[lane]); // the step that filled the buffer
+        reference_jump(lanes[lane], LONG_JUMP);
+        CHECK(same_lane(rng, lane, lanes[lane]), "rng_jump moves lane " << lane << " 2^96 steps ahead");
+    }
+    CHECK(random_int(rng) == reference_next(lanes[0]), "the first output after rng_jump is from the jumped state");
+}
+
+static const size_t BATCH_SIZES[] = {0, 1, 3, 7, 8, 9, 13, 31, 64, 65, 127, 300};
+
+// The batch functions give what as many single calls would, wherever in the buffer they start, and leave
+// the component where those calls would have.
+static void check_batches(){
+    for(size_t offset = 0; offset <= RNG_LANES; offset++){
+        for(size_t count : BATCH_SIZES){
+            RNGComponent batch = new_rng_component(offset * 1000 + count);
+            RNGComponent single = batch;
+            for(size_t i = 0; i < offset; i++){
+                random_int(batch);
+                random_int(single);
+            }
+
+            std::vector<unsigned int> ints(count);
+            random_ints(batch, ints.data(), count);
+            bool isSame = true;
+            for(size_t i = 0; i < count; i++){
+                isSame &= ints[i] == random_int(single);
+            }
+            CHECK(isSame, "random_ints of " << count << " from offset " << offset << " matches random_int");
+
+            std::vector<float> floats(count);
+            random_floats(batch, floats.data(), count);
+            isSame = true;
+            for(size_t i = 0; i < count; i++){
+                isSame &= floats[i] == random_float(single);
+            }
+            CHECK(isSame, "random_floats of " << count << " from offset " << offset << " matches random_float");
+
+            random_floats(batch, floats.data(), count, -3.f, 5.f);
+            isSame = true;
+            for(size_t i = 0; i < count; i++){
+                isSame &= floats[i] == random_float(single, -3.f, 5.f);
+            }
+            CHECK(isSame, "bounded random_floats of " << count << " from offset " << offset << " matches random_float");
+
+            CHECK(random_int(batch) == random_int(single), "the batches of " << count << " from offset " << offset << " leave the same state");
+        }
+    }
+}
+
+static void check_bounds(){
+    RNGComponent rng = new_rng_component(42);
+    const unsigned int bounds[] = {1, 2, 3, 5, 7, 10, 100, 1000, 65537, 0x7fffffff, 0x80000001, 0xc0000000, 0xfffffffe, 0xffffffff};
+    for(unsigned int bound : bounds){
+        bool isInBounds = true;
+        for(size_t i = 0; i < 10000; i++){
+            isInBounds &= random_int(rng, bound) < bound;
+            isInBounds &= random_int_fast(rng, bound) < bound;
+            unsigned int value = random_int(rng, 10, 10 + bound);
+            isInBounds &= value - 10 < bound; // wraps around for the largest bounds
+        }
+        CHECK(isInBounds, "random_int(rng, " << bound << ") is below its bound");
+    }
+    CHECK(random_int(rng, 1) == 0, "random_int(rng, 1) is 0");
+
+    bool isInUnitRange = true;
+    for(size_t i = 0; i < 100000; i++){
+        float value = random_float(rng);
+        isInUnitRange &= value >= 0.f && value < 1.f;
+    }
+    CHECK(isInUnitRange, "random_float is in [0, 1)");
+}
+
+/*
+    With a bound of 3 * 2^30, multiply-shift maps every 4 consecutive ints to results 3k, 3k, 3k + 1 and
+    3k + 2, so half of its results are multiples of 3, where an unbiased random_int gives a third.
+*/
+static void check_unbiased(){
+    const unsigned int bound = 0xc0000000;
+    const size_t samples = 30000;
+    RNGComponent rng = new_rng_component(7);
+    size_t multiples = 0;
+    size_t fastMultiples = 0;
+    for(size_t i = 0; i < samples; i++){
+        multiples += random_int(rng, bound) % 3 == 0;
+        fastMultiples += random_int_fast(rng, bound) % 3 == 0;
+    }
+    float ratio = (float)multiples / samples;
+    float fastRatio = (float)fastMultiples / samples;
+    CHECK(ratio > 0.31f && ratio < 0.36f, "random_int is unbiased (a third of multiples of 3, got " << ratio << ")");
+    CHECK(fastRatio > 0.47f && fastRatio < 0.53f, "random_int_fast has the multiply-shift bias (got " << fastRatio << ")");
+}
+
+// A split stream and the one it was split from don't share any pair of consecutive outputs.
+static void check_split_streams(){
+    const size_t count = 1 << 16;
+    RNGComponent rng = new_rng_component(99);
+    random_int(rng);
+    std::vector<RNGComponent> streams;
+    for(size_t i = 0; i < 3; i++){
+        streams.push_back(rng_split(rng));
+    }
+    streams.push_back(rng);
+
+    std::unordered_set<uint64_t> seen;
+    size_t shared = 0;
+    for(RNGComponent& stream : streams){
+        uint32_t previous = random_int(stream);
+        for(size_t i = 1; i < count; i++){
+            uint32_t next = random_int(stream);
+            shared += !seen.insert((uint64_t)previous << 32 | next).second;
+            previous = next;
+        }
+    }
+    CHECK(shared == 0, "split streams share no outputs (" << shared << " pairs shared)");
+}
+
+int main(){
+    check_reference_stream();
+    check_batches();
+    check_bounds();
+    check_unbiased();
+    check_split_streams();
+
+    return finish_checks();
+}
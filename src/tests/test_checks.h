@@ -0,0 +1,23 @@
+// Checks shared by the test programs that run without a window: CHECK reports and counts a failed
+// condition, and finish_checks() gives main's exit code.
+#pragma once
+#include<iostream>
+
+inline int _failedChecks = 0;
+
+#define CHECK(condition, what) \
+    do { \
+        if(!(condition)){ \
+            std::cerr << "FAILED: " << what << " (" #condition ")\n"; \
+            _failedChecks++; \
+        } \
+    } while(0)
+
+inline int finish_checks(){
+    if(_failedChecks > 0){
+        std::cerr << _failedChecks << " checks failed\n";
+        return 1;
+    }
+    std::cout << "All checks passed\n";
+    return 0;
+}
@@ -0,0 +1,151 @@
+// Checks the TextureAtlas SkylinePacker (rectangles stay inside the area and never overlap, and a full area
+// is filled without gaps) and build_pages (every packable image is copied to where its placement says, and
+// the others are left out). Works on the CPU only, no window needed.
+#include<raylib.h>
+#include"texture_atlas.h"
+#include"test_checks.h"
+#include<algorithm>
+#include<cstdlib>
+#include<cstring>
+#include<vector>
+
+struct PlacedRect {
+    int x, y, width, height;
+};
+
+static bool overlap(const PlacedRect& a, const PlacedRect& b){
+    return a.x < b.x + b.width && b.x < a.x + a.width && a.y < b.y + b.height && b.y < a.y + a.height;
+}
+
+static bool any_overlap(const std::vector<PlacedRect>& rects){
+    for(size_t i = 0; i < rects.size(); i++){
+        for(size_t j = i + 1; j < rects.size(); j++){
+            if(overlap(rects[i], rects[j])){
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+static void check_random_rects(){
+    const int size = 1024;
+    TextureAtlas::SkylinePacker packer(size, size);
+    std::vector<PlacedRect> rects;
+    std::srand(5);
+    size_t rejected = 0;
+    for(size_t i = 0; i < 2000; i++){
+        PlacedRect rect{-1, -1, 1 + std::rand() % 100, 1 + std::rand() % 100};
+        if(packer.insert(rect.width, rect.height, rect.x, rect.y)){
+            rects.push_back(rect);
+        } else {
+            CHECK(rect.x == -1 && rect.y == -1, "a failed insert leaves x and y untouched");
+            rejected++;
+        }
+    }
+    CHECK(rejected > 0, "the area eventually fills up");
+
+    bool isInside = true;
+    int usedWidth = 0;
+    int usedHeight = 0;
+    for(const PlacedRect& rect : rects){
+        isInside &= rect.x >= 0 && rect.y >= 0 && rect.x + rect.width <= size && rect.y + rect.height <= size;
+        usedWidth = std::max(usedWidth, rect.x + rect.width);
+        usedHeight = std::max(usedHeight, rect.y + rect.height);
+    }
+    CHECK(isInside, "every rectangle is inside the area");
+    CHECK(!any_overlap(rects), "no two rectangles overlap");
+    CHECK(packer.used_width() == usedWidth && packer.used_height() == usedHeight, "the used area is the bounding box of the rectangles");
+}
+
+static void check_exact_fill(){
+    TextureAtlas::SkylinePacker packer(256, 256);
+    std::vector<PlacedRect> rects;
+    bool isInserted = true;
+    for(size_t i = 0; i < 16; i++){
+        PlacedRect rect{0, 0, 64, 64};
+        isInserted &= packer.insert(rect.width, rect.height, rect.x, rect.y);
+        rects.push_back(rect);
+    }
+    CHECK(isInserted, "16 squares of a quarter of the side fill the area");
+    CHECK(!any_overlap(rects), "the squares filling the area don't overlap");
+    int x, y;
+    CHECK(!packer.insert(1, 1, x, y), "nothing fits in a full area");
+    CHECK(packer.used_width() == 256 && packer.used_height() == 256, "a full area is used completely");
+
+    TextureAtlas::SkylinePacker empty(256, 256);
+    CHECK(!empty.insert(257, 1, x, y) && !empty.insert(1, 257, x, y), "rectangles larger than the area don't fit");
+}
+
+static Color image_color(size_t i){
+    return Color{(unsigned char)(i * 37), (unsigned char)(i * 11 + 1), (unsigned char)(i * 97 + 2), 255};
+}
+
+static bool has_pixels_at(const Image& page, const Image& image, int x, int y){
+    if(x + image.width > page.width || y + image.height > page.height){
+        return false;
+    }
+    const unsigned char* pagePixels = static_cast<const unsigned char*>(page.data);
+    const unsigned char* imagePixels = static_cast<const unsigned char*>(image.data);
+    for(int row = 0; row < image.height; row++){
+        if(std::memcmp(pagePixels + ((size_t)(y + row) * page.width + x) * 4, imagePixels + (size_t)row * image.width * 4, (size_t)image.width * 4) != 0){
+            return false;
+        }
+    }
+    return true;
+}
+
+static void check_build_pages(){
+    std::vector<Image> images;
+    // 500x500 images take a quarter of a page side each (with padding), so 20 of them need two pages
+    for(size_t i = 0; i < 20; i++){
+        images.push_back(GenImageColor(500, 500, image_color(i)));
+    }
+    for(size_t i = 20; i < 60; i++){
+        images.push_back(GenImageColor(1 + i % 7 * 9, 1 + i % 5 * 13, image_color(i)));
+    }
+    size_t tooLarge = images.size();
+    images.push_back(GenImageColor(TextureAtlas::MAX_PACKED_TEXTURE_SIZE + 1, 8, RED));
+    size_t notRGBA8 = images.size();
+    images.push_back(GenImageColor(8, 8, RED));
+    ImageFormat(&images.back(), PIXELFORMAT_UNCOMPRESSED_GRAYSCALE);
+
+    std::vector<TextureAtlas::Placement> placements;
+    std::vector<Image> pages = TextureAtlas::build_pages(images, placements);
+    CHECK(placements.size() == images.size(), "every image has a placement");
+    CHECK(pages.size() == 2, "the images fit in two pages (got " << pages.size() << ")");
+    CHECK(!placements[tooLarge].isPacked, "an image larger than MAX_PACKED_TEXTURE_SIZE is left out");
+    CHECK(!placements[notRGBA8].isPacked, "an image that isn't R8G8B8A8 is left out");
+
+    std::vector<std::vector<PlacedRect>> pageRects(pages.size());
+    for(size_t i = 0; i < tooLarge; i++){
+        const TextureAtlas::Placement& placement = placements[i];
+        CHECK(placement.isPacked && placement.page < pages.size(), "image " << i << " is packed");
+        if(!placement.isPacked || placement.page >= pages.size()){
+            continue;
+        }
+        CHECK(has_pixels_at(pages[placement.page], images[i], placement.x, placement.y), "image " << i << " is copied to its placement");
+        pageRects[placement.page].push_back(PlacedRect{placement.x, placement.y,
+            images[i].width + TextureAtlas::PADDING, images[i].height + TextureAtlas::PADDING});
+    }
+    for(size_t page = 0; page < pages.size(); page++){
+        CHECK(pages[page].width <= TextureAtlas::PAGE_SIZE && pages[page].height <= TextureAtlas::PAGE_SIZE, "page " << page << " isn't larger than PAGE_SIZE");
+        CHECK(!any_overlap(pageRects[page]), "the images of page " << page << " don't overlap, padding included");
+    }
+
+    for(Image& page : pages){
+        UnloadImage(page);
+    }
+    for(Image& image : images){
+        UnloadImage(image);
+    }
+}
+
+int main(){
+    SetTraceLogLevel(LOG_WARNING);
+    check_random_rects();
+    check_exact_fill();
+    check_build_pages();
+
+    return finish_checks();
+}
@@ -0,0 +1,90 @@
+// Checks util::TripleBuffer: on one thread, that the reader only sees published values and always the latest
+// one; on two threads, that the reader never sees a value the writer is still filling, and never sees an
+// older value after a newer one.
+#include"utility/triple_buffer.h"
+#include"test_checks.h"
+#include<atomic>
+#include<cstdint>
+#include<iostream>
+#include<thread>
+#include<vector>
+
+static void check_single_thread(){
+    util::TripleBuffer<int> buffer;
+    buffer.read_buffer() = -1;
+    CHECK(!buffer.update_read_buffer() && buffer.read_buffer() == -1, "nothing is picked up before a publish");
+
+    buffer.write_buffer() = 1;
+    CHECK(!buffer.update_read_buffer(), "an unpublished value isn't picked up");
+    buffer.publish();
+    CHECK(buffer.update_read_buffer() && buffer.read_buffer() == 1, "a published value is picked up");
+    CHECK(!buffer.update_read_buffer() && buffer.read_buffer() == 1, "a value is only picked up once");
+
+    for(int value = 2; value <= 5; value++){
+        buffer.write_buffer() = value;
+        buffer.publish();
+    }
+    CHECK(buffer.update_read_buffer() && buffer.read_buffer() == 5, "only the latest of several publishes is picked up");
+
+    // the writer never gets the buffer the reader holds
+    for(int value = 6; value < 20; value++){
+        CHECK(&buffer.write_buffer() != &buffer.read_buffer(), "the write and read buffers are different");
+        buffer.write_buffer() = value;
+        buffer.publish();
+        if(value % 3 == 0){
+            buffer.update_read_buffer();
+        }
+    }
+}
+
+// Every element of a published frame holds the same value, so a frame being filled while read shows up as a mix.
+struct Frame {
+    std::vector<uint32_t> values;
+};
+
+static void check_two_threads(){
+    const uint32_t publishes = 200000;
+    const size_t frameSize = 64;
+    util::TripleBuffer<Frame> buffer;
+    std::atomic<bool> isDone{false};
+
+    std::thread writer([&buffer, &isDone, publishes, frameSize](){
+        for(uint32_t value = 1; value <= publishes; value++){
+            buffer.write_buffer().values.assign(frameSize, value);
+            buffer.publish();
+        }
+        isDone.store(true, std::memory_order_release);
+    });
+
+    uint32_t last = 0;
+    size_t torn = 0;
+    size_t backwards = 0;
+    size_t pickedUp = 0;
+    bool isWriterDone = false;
+    while(!isWriterDone){
+        // checking for completion before picking up makes sure the last value is picked up too
+        isWriterDone = isDone.load(std::memory_order_acquire);
+        if(!buffer.update_read_buffer()){
+            continue;
+        }
+        pickedUp++;
+        const std::vector<uint32_t>& values = buffer.read_buffer().values;
+        for(uint32_t value : values){
+            torn += value != values[0];
+        }
+        backwards += values[0] <= last;
+        last = values[0];
+    }
+    writer.join();
+    CHECK(torn == 0, "no frame is read while being written (" << torn << " torn values)");
+    CHECK(backwards == 0, "every frame picked up is newer than the last one (" << backwards << " weren't)");
+    CHECK(last == publishes, "the last frame published is picked up (got " << last << ")");
+    std::cout << "Picked up " << pickedUp << " of " << publishes << " frames\n";
+}
+
+int main(){
+    check_single_thread();
+    check_two_threads();
+
+    return finish_checks();
+}
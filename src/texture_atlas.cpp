@@ -0,0 +1,124 @@
+#include"texture_atlas.h"
+#include<algorithm>
+#include<cstring>
+
+TextureAtlas::SkylinePacker::SkylinePacker(int width, int height) : width{width}, height{height} {
+    skyline.push_back(Segment{0, 0, width});
+}
+
+int TextureAtlas::SkylinePacker::fit(size_t idx, int rectWidth, int rectHeight) const {
+    int x = skyline[idx].x;
+    if(x + rectWidth > width){
+        return -1;
+    }
+    int y = 0;
+    int widthLeft = rectWidth;
+    for(size_t i = idx; widthLeft > 0; i++){
+        y = std::max(y, skyline[i].y);
+        if(y + rectHeight > height){
+            return -1;
+        }
+        widthLeft -= skyline[i].width;
+    }
+    return y;
+}
+
+bool TextureAtlas::SkylinePacker::insert(int rectWidth, int rectHeight, int& x, int& y){
+    size_t bestIdx = skyline.size();
+    int bestY = height;
+    for(size_t i = 0; i < skyline.size(); i++){
+        int fitY = fit(i, rectWidth, rectHeight);
+        if(fitY >= 0 && fitY < bestY){
+            bestIdx = i;
+            bestY = fitY;
+        }
+    }
+    if(bestIdx == skyline.size()){
+        return false;
+    }
+    Segment newSegment{skyline[bestIdx].x, bestY + rectHeight, rectWidth};
+    skyline.insert(skyline.begin() + bestIdx, newSegment);
+    // the segments now covered by the new one get shortened or removed
+    size_t i = bestIdx + 1;
+    while(i < skyline.size()){
+        int newSegmentEnd = newSegment.x + newSegment.width;
+        if(skyline[i].x >= newSegmentEnd){
+            break;
+        }
+        int overlap = newSegmentEnd - skyline[i].x;
+        skyline[i].x += overlap;
+        skyline[i].width -= overlap;
+        if(skyline[i].width > 0){
+            break;
+        }
+        skyline.erase(skyline.begin() + i);
+    }
+    // merges neighbouring segments at the same height
+    for(size_t j = 0; j + 1 < skyline.size();){
+        if(skyline[j].y == skyline[j+1].y){
+            skyline[j].width += skyline[j+1].width;
+            skyline.erase(skyline.begin() + j + 1);
+        } else {
+            j++;
+        }
+    }
+    x = newSegment.x;
+    y = bestY;
+    usedWidth = std::max(usedWidth, x + rectWidth);
+    usedHeight = std::max(usedHeight, y + rectHeight);
+    return true;
+}
+
+// Copies the whole (R8G8B8A8) image `source` into `destination` with its upper left corner at (x, y).
+static void copy_image_pixels(Image& destination, const Image& source, int x, int y){
+    const unsigned char* sourcePixels = static_cast<const unsigned char*>(source.data);
+    unsigned char* destinationPixels = static_cast<unsigned char*>(destination.data);
+    for(int row = 0; row < source.height; row++){
+        std::memcpy(
+            destinationPixels + ((size_t)(y + row) * destination.width + x) * 4,
+            sourcePixels + (size_t)row * source.width * 4,
+            (size_t)source.width * 4
+        );
+    }
+}
+
+std::vector<Image> TextureAtlas::build_pages(const std::vector<Image>& images, std::vector<Placement>& placements){
+    placements.assign(images.size(), Placement{});
+    // the tallest images go first, which keeps the skyline flat
+    std::vector<size_t> packingOrder;
+    for(size_t i = 0; i < images.size(); i++){
+        const Image& image = images[i];
+        if(image.data != nullptr && image.format == PIXELFORMAT_UNCOMPRESSED_R8G8B8A8 && image.width > 0 && image.height > 0 &&
+           image.width <= MAX_PACKED_TEXTURE_SIZE && image.height <= MAX_PACKED_TEXTURE_SIZE){
+            packingOrder.push_back(i);
+        }
+    }
+    std::sort(packingOrder.begin(), packingOrder.end(), [&images](size_t a, size_t b){
+        return (images[a].height != images[b].height) ? images[a].height > images[b].height : images[a].width > images[b].width;
+    });
+    std::vector<SkylinePacker> pagePackers;
+    for(size_t i : packingOrder){
+        Placement& placement = placements[i];
+        int paddedWidth = images[i].width + PADDING;
+        int paddedHeight = images[i].height + PADDING;
+        size_t page = 0;
+        while(page < pagePackers.size() && !pagePackers[page].insert(paddedWidth, paddedHeight, placement.x, placement.y)){
+            page++;
+        }
+        if(page == pagePackers.size()){
+            pagePackers.emplace_back(PAGE_SIZE, PAGE_SIZE);
+            pagePackers.back().insert(paddedWidth, paddedHeight, placement.x, placement.y);
+        }
+        placement.page = page;
+        placement.isPacked = true;
+    }
+
+    std::vector<Image> pages;
+    for(size_t page = 0; page < pagePackers.size(); page++){
+        pages.push_back(GenImageColor(pagePackers[page].used_width(), pagePackers[page].used_height(), BLANK));
+    }
+    for(size_t i : packingOrder){
+        copy_image_pixels(pages[placements[i].page], images[i], placements[i].x, placements[i].y);
+    }
+    return pages;
+}
@@ -2,28 +2,33 @@
 #include "collision_component.h"
 #include "collision_shapes.h"
 #include "entt.hpp"
+#include "job_system.h"
 #include "raylib.h"
 #include "sprite_loader.h"
 #include "utility/vector2_util.h"
+#include <algorithm>
+#include <cmath>
 
 TilesetTile::TilesetTile(const char* textureFilename, TilesetTile::TileCollisionPreset preset){
-    texture = SpriteLoader::load_or_get_texture(textureFilename);
+    SpriteLoader::TextureRegion region = SpriteLoader::load_or_get_texture_region(textureFilename);
+    texture = region.texture;
+    source = region.source;
     switch(preset){
       case TileCollisionPreset::NONE:
         collision = CollisionComponent();
         break;
       case TileCollisionPreset::SOLID:
-        collision = CollisionComponent(new CollisionRect(VEC2_ZERO, texture.width, texture.height));
+        collision = CollisionComponent(new CollisionRect(VEC2_ZERO, source.width, source.height));
         break;
       case TileCollisionPreset::SLOPE_SW_TO_NE:
-        collision = CollisionComponent(new CollisionLine(Vector2{0, (float)texture.height}, Vector2{(float)texture.width, 0}));
+        collision = CollisionComponent(new CollisionLine(Vector2{0, source.height}, Vector2{source.width, 0}));
         break;
       case TileCollisionPreset::SLOPE_NW_TO_SE:
-        collision = CollisionComponent(new CollisionLine(VEC2_ZERO, Vector2{(float)texture.width, (float)texture.height}));
+        collision = CollisionComponent(new CollisionLine(VEC2_ZERO, Vector2{source.width, source.height}));
         break;
       case TileCollisionPreset::CIRCULAR:
-        float circleDiameter = std::min(texture.width, texture.height);
-        Vector2 circleCenter = {texture.width / 2.f, texture.height / 2.f};
+        float circleDiameter = std::min(source.width, source.height);
+        Vector2 circleCenter = {source.width / 2.f, source.height / 2.f};
         collision = CollisionComponent(new CollisionCircle(circleCenter, circleDiameter / 2));
         break;
     }
@@ -37,6 +42,7 @@ TilesetTile::~TilesetTile() {
 
 TilesetTile::TilesetTile(const TilesetTile& other){
     this->id = other.id;
+    this->source = other.source;
     clone_collision(other.collision, this->collision);
     if(other.texture.id != 0) this->texture = SpriteLoader::get_texture_copy(other.texture);
 }
@@ -45,12 +51,96 @@ TilesetTile::TilesetTile(const TilesetTile& other){
 TilesetTile& TilesetTile::operator=(const TilesetTile& rhs){
     if(this != &rhs){
         this->id = rhs.id;
+        this->source = rhs.source;
         clone_collision(rhs.collision, this->collision);
         if(rhs.texture.id != 0) this->texture = SpriteLoader::get_texture_copy(rhs.texture);
     }
     return *this;
 }
 
+static void unload_render_texture_from_any_thread(RenderTexture2D target){
+    if(JobSystem::is_main_thread()){
+        UnloadRenderTexture(target);
+    } else {
+        JobSystem::run_on_main_thread([target]{ UnloadRenderTexture(target); });
+    }
+}
+
+TilesetChunkCache::~TilesetChunkCache(){
+    clear();
+}
+
+TilesetChunkCache::TilesetChunkCache(TilesetChunkCache&& other) :
+    chunks{std::move(other.chunks)},
+    dirty{std::move(other.dirty)},
+    chunkRows{other.chunkRows},
+    chunkCols{other.chunkCols},
+    mapRows{other.mapRows},
+    mapCols{other.mapCols}
+{
+    other.chunks.clear();
+    other.dirty.clear();
+    other.chunkRows = other.chunkCols = 0;
+    other.mapRows = other.mapCols = 0;
+}
+
+TilesetChunkCache& TilesetChunkCache::operator=(TilesetChunkCache&& rhs){
+    if(this != &rhs){
+        clear();
+        chunks = std::move(rhs.chunks);
+        dirty = std::move(rhs.dirty);
+        chunkRows = rhs.chunkRows;
+        chunkCols = rhs.chunkCols;
+        mapRows = rhs.mapRows;
+        mapCols = rhs.mapCols;
+        rhs.chunks.clear();
+        rhs.dirty.clear();
+        rhs.chunkRows = rhs.chunkCols = 0;
+        rhs.mapRows = rhs.mapCols = 0;
+    }
+    return *this;
+}
+
+void TilesetChunkCache::clear(){
+    for(const RenderTexture2D& chunk : chunks){
+        if(chunk.id != 0) unload_render_texture_from_any_thread(chunk);
+    }
+    chunks.clear();
+    dirty.clear();
+    chunkRows = chunkCols = 0;
+    mapRows = mapCols = 0;
+}
+
+// Reallocates the chunk grid (with every chunk dirty) if the tilemap changed size since it was allocated.
+static void sync_chunk_grid(const TilesetComponent& tileset){
+    TilesetChunkCache& cache = tileset.chunkCache;
+    if(cache.mapRows == tileset.map.rows() && cache.mapCols == tileset.map.cols() && !cache.dirty.empty()){
+        return;
+    }
+    cache.clear();
+    cache.mapRows = tileset.map.rows();
+    cache.mapCols = tileset.map.cols();
+    cache.chunkRows = (cache.mapRows + TILESET_CHUNK_SIZE - 1) / TILESET_CHUNK_SIZE;
+    cache.chunkCols = (cache.mapCols + TILESET_CHUNK_SIZE - 1) / TILESET_CHUNK_SIZE;
+    cache.chunks.assign(cache.chunkRows * cache.chunkCols, RenderTexture2D{});
+    cache.dirty.assign(cache.chunkRows * cache.chunkCols, true);
+}
+
+void tileset_mark_dirty(const TilesetComponent& tileset, size_t row, size_t col){
+    sync_chunk_grid(tileset);
+    TilesetChunkCache& cache = tileset.chunkCache;
+    size_t chunkRow = row / TILESET_CHUNK_SIZE;
+    size_t chunkCol = col / TILESET_CHUNK_SIZE;
+    if(chunkRow < cache.chunkRows && chunkCol < cache.chunkCols){
+        cache.dirty[chunkRow * cache.chunkCols + chunkCol] = true;
+    }
+}
+
+void tileset_mark_all_dirty(const TilesetComponent& tileset){
+    sync_chunk_grid(tileset);
+    std::fill(tileset.chunkCache.dirty.begin(), tileset.chunkCache.dirty.end(), true);
+}
+
 TilesetComponent::TilesetComponent(size_t gridRows, size_t gridCols) : TilesetComponent() {
     map = util::Matrix<TileID>(gridRows, gridCols, -1);
     for(TileID tileID : map){
@@ -71,6 +161,7 @@ void tileset_clear_all(TilesetComponent& tileset){
     tileset.tiles.clear();
     tileset.map.clear();
     tileset.tileSize = VEC2_ZERO;
+    tileset.chunkCache.clear();
 }
 
 bool tileset_is_tile_in_range(const TilesetComponent &tileset, size_t row, size_t col)
@@ -123,13 +214,15 @@ void tileset_fit_map_to_content(TilesetComponent& tileset){
 
 void tileset_place_tile(TilesetComponent& tileset, size_t row, size_t col, TileID id){
     if(!tileset_is_tile_in_range(tileset, row, col)){
-        tileset.map.resize(row+1, col+1, -1);
+        tileset.map.resize(std::max(row+1, tileset.map.rows()), std::max(col+1, tileset.map.cols()), -1);
     }
     tileset.map[row][col] = id;
+    tileset_mark_dirty(tileset, row, col);
 }
 
 void tileset_remove_tile(TilesetComponent& tileset, size_t row, size_t col){
     tileset.map[row][col] = -1;
+    tileset_mark_dirty(tileset, row, col);
 }
 
 void tileset_remove_all_tiles(TilesetComponent& tileset, TileID targetID){
@@ -144,17 +237,27 @@ void tileset_remove_all_tiles(TilesetComponent& tileset, TileID targetID){
             }
         }
     }
+    tileset_mark_all_dirty(tileset);
 }
 
 void tileset_fill_tiles(TilesetComponent& tileset, size_t beginRow, size_t endRow, size_t beginCol, size_t endCol, TileID fill){
-    if(!tileset_is_tile_in_range(tileset, endRow, endCol)){
-        tileset.map.resize(endRow+1, endCol+1);
+    if(!tileset_is_tile_in_range(tileset, endRow - 1, endCol - 1)){
+        tileset.map.resize(std::max(endRow, tileset.map.rows()), std::max(endCol, tileset.map.cols()), -1);
     }
     for(int i = beginRow; i < endRow; i++){
         for(int j = beginCol; j < endCol; j++){
             tileset.map[i][j] = fill;
         }
     }
+    if(beginRow >= endRow || beginCol >= endCol){
+        return;
+    }
+    // marks every chunk the rectangle touches
+    for(size_t i = beginRow / TILESET_CHUNK_SIZE; i <= (endRow - 1) / TILESET_CHUNK_SIZE; i++){
+        for(size_t j = beginCol / TILESET_CHUNK_SIZE; j <= (endCol - 1) / TILESET_CHUNK_SIZE; j++){
+            tileset_mark_dirty(tileset, i * TILESET_CHUNK_SIZE, j * TILESET_CHUNK_SIZE);
+        }
+    }
 }
 
 void tileset_get_complete_collision(const TilesetComponent& tileset, CollisionComponent& collision){
@@ -174,30 +277,156 @@ void tileset_get_complete_collision(const TilesetComponent& tileset, CollisionCo
     }
 }
 
-void draw_tileset(const TilesetComponent& tileset, const Position& pos){
-    Vector2 posVector = to_Vector2(pos);
-    size_t tilemapRows = tileset.map.rows();
-    size_t tilemapCols = tileset.map.cols();
-    for(size_t i = 0; i < tilemapRows; i++){
-        for(size_t j = 0; j < tilemapCols; j++){
+// Draws the tiles in rows [beginRow, endRow) and columns [beginCol, endCol) one by one, with the
+// tile at (beginRow, beginCol) placed at `origin`. The tiles are queued in `queue` if there's one,
+// and drawn right away otherwise.
+static void draw_tiles(const TilesetComponent& tileset, size_t beginRow, size_t endRow, size_t beginCol, size_t endCol, Vector2 origin,
+                       RenderQueue* queue = nullptr){
+    for(size_t i = beginRow; i < endRow; i++){
+        for(size_t j = beginCol; j < endCol; j++){
             TileID tileID = tileset.map[i][j];
             if(tileID < tileset.tiles.size()){
                 const TilesetTile& tile = tileset.tiles[tileID];
-                Vector2 tilePos = to_Vector2(tileset_get_tile_pos(tileset, i, j)) + posVector;
-                Rectangle tileRect = {
-                    .x = 0,
-                    .y = 0,
-                    .width = (float)tile.texture.width,
-                    .height = (float)tile.texture.height,
-                };
                 Rectangle destRect = {
-                    .x = tilePos.x,
-                    .y = tilePos.y,
+                    .x = origin.x + tileset.tileSize.x * (j - beginCol),
+                    .y = origin.y + tileset.tileSize.y * (i - beginRow),
                     .width = tileset.tileSize.x,
                     .height = tileset.tileSize.y
                 };
-                DrawTexturePro(tile.texture, tileRect, destRect, VEC2_ZERO, 0, WHITE);
+                if(queue != nullptr){
+                    queue->push_texture(RenderLayer::TILEMAPS, tile.texture, tile.source, destRect);
+                } else {
+                    DrawTexturePro(tile.texture, tile.source, destRect, VEC2_ZERO, 0, WHITE);
+                }
+            }
+        }
+    }
+}
+
+void tileset_get_tiles_in_area(const TilesetComponent& tileset, const Position& pos, const WorldAABB& area,
+                               size_t& beginRow, size_t& endRow, size_t& beginCol, size_t& endCol){
+    size_t rows = tileset.map.rows();
+    size_t cols = tileset.map.cols();
+    if(tileset.tileSize.x <= 0 || tileset.tileSize.y <= 0){
+        beginRow = beginCol = 0;
+        endRow = rows;
+        endCol = cols;
+        return;
+    }
+    // clamps to [0, limit] before converting, so that areas far outside the map don't overflow
+    auto to_index = [](float value, size_t limit){
+        return (size_t)std::clamp(value, 0.f, (float)limit);
+    };
+    beginRow = to_index(std::floor((area.min.y - pos.y) / tileset.tileSize.y), rows);
+    endRow = to_index(std::ceil((area.max.y - pos.y) / tileset.tileSize.y), rows);
+    beginCol = to_index(std::floor((area.min.x - pos.x) / tileset.tileSize.x), cols);
+    endCol = to_index(std::ceil((area.max.x - pos.x) / tileset.tileSize.x), cols);
+    if(beginRow >= endRow || beginCol >= endCol){
+        beginRow = endRow = beginCol = endCol = 0;
+    }
+}
+
+// Outputs the range of chunks that contain the tiles in rows [beginRow, endRow) and columns [beginCol, endCol).
+static void get_chunks_in_range(size_t beginRow, size_t endRow, size_t beginCol, size_t endCol,
+                                size_t& beginChunkRow, size_t& endChunkRow, size_t& beginChunkCol, size_t& endChunkCol){
+    beginChunkRow = beginRow / TILESET_CHUNK_SIZE;
+    endChunkRow = (endRow + TILESET_CHUNK_SIZE - 1) / TILESET_CHUNK_SIZE;
+    beginChunkCol = beginCol / TILESET_CHUNK_SIZE;
+    endChunkCol = (endCol + TILESET_CHUNK_SIZE - 1) / TILESET_CHUNK_SIZE;
+}
+
+void tileset_bake_dirty_chunks(const TilesetComponent& tileset, const Position& pos, const WorldAABB& view){
+    if(tileset.tileSize.x <= 0 || tileset.tileSize.y <= 0){
+        return; // nothing sensible to bake, draw_tileset draws tile by tile
+    }
+    sync_chunk_grid(tileset);
+    TilesetChunkCache& cache = tileset.chunkCache;
+    size_t beginRow, endRow, beginCol, endCol;
+    tileset_get_tiles_in_area(tileset, pos, view, beginRow, endRow, beginCol, endCol);
+    size_t beginChunkRow, endChunkRow, beginChunkCol, endChunkCol;
+    get_chunks_in_range(beginRow, endRow, beginCol, endCol, beginChunkRow, endChunkRow, beginChunkCol, endChunkCol);
+    for(size_t chunkRow = beginChunkRow; chunkRow < endChunkRow; chunkRow++){
+        for(size_t chunkCol = beginChunkCol; chunkCol < endChunkCol; chunkCol++){
+            size_t chunkIdx = chunkRow * cache.chunkCols + chunkCol;
+            if(!cache.dirty[chunkIdx]){
+                continue;
+            }
+            size_t chunkBeginRow = chunkRow * TILESET_CHUNK_SIZE;
+            size_t chunkBeginCol = chunkCol * TILESET_CHUNK_SIZE;
+            size_t chunkEndRow = std::min(chunkBeginRow + TILESET_CHUNK_SIZE, cache.mapRows);
+            size_t chunkEndCol = std::min(chunkBeginCol + TILESET_CHUNK_SIZE, cache.mapCols);
+            RenderTexture2D& chunk = cache.chunks[chunkIdx];
+            if(chunk.id == 0){
+                // chunks at the right and bottom edges only cover the tiles left
+                int width = (int)std::ceil(tileset.tileSize.x * (chunkEndCol - chunkBeginCol));
+                int height = (int)std::ceil(tileset.tileSize.y * (chunkEndRow - chunkBeginRow));
+                chunk = LoadRenderTexture(width, height);
+                if(chunk.id == 0){
+                    continue;
+                }
+            }
+            BeginTextureMode(chunk);
+                ClearBackground(BLANK);
+                draw_tiles(tileset, chunkBeginRow, chunkEndRow, chunkBeginCol, chunkEndCol, VEC2_ZERO);
+            EndTextureMode();
+            cache.dirty[chunkIdx] = false;
+        }
+    }
+}
+
+bool tileset_has_dirty_chunks(const TilesetComponent& tileset, const Position& pos, const WorldAABB& view){
+    if(tileset.tileSize.x <= 0 || tileset.tileSize.y <= 0){
+        return false;
+    }
+    const TilesetChunkCache& cache = tileset.chunkCache;
+    if(cache.mapRows != tileset.map.rows() || cache.mapCols != tileset.map.cols() || cache.dirty.empty()){
+        return true; // the chunk grid gets (re)allocated with every chunk dirty
+    }
+    size_t beginRow, endRow, beginCol, endCol;
+    tileset_get_tiles_in_area(tileset, pos, view, beginRow, endRow, beginCol, endCol);
+    size_t beginChunkRow, endChunkRow, beginChunkCol, endChunkCol;
+    get_chunks_in_range(beginRow, endRow, beginCol, endCol, beginChunkRow, endChunkRow, beginChunkCol, endChunkCol);
+    for(size_t chunkRow = beginChunkRow; chunkRow < endChunkRow; chunkRow++){
+        for(size_t chunkCol = beginChunkCol; chunkCol < endChunkCol; chunkCol++){
+            if(cache.dirty[chunkRow * cache.chunkCols + chunkCol]){
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+void draw_tileset(const TilesetComponent& tileset, const Position& pos, const WorldAABB& view, RenderQueue& queue){
+    Vector2 posVector = to_Vector2(pos);
+    size_t beginRow, endRow, beginCol, endCol;
+    tileset_get_tiles_in_area(tileset, pos, view, beginRow, endRow, beginCol, endCol);
+    const TilesetChunkCache& cache = tileset.chunkCache;
+    if(cache.mapRows != tileset.map.rows() || cache.mapCols != tileset.map.cols() || cache.dirty.empty()){
+        Vector2 origin = to_Vector2(tileset_get_tile_pos(tileset, beginRow, beginCol)) + posVector;
+        draw_tiles(tileset, beginRow, endRow, beginCol, endCol, origin, &queue);
+        return;
+    }
+    size_t beginChunkRow, endChunkRow, beginChunkCol, endChunkCol;
+    get_chunks_in_range(beginRow, endRow, beginCol, endCol, beginChunkRow, endChunkRow, beginChunkCol, endChunkCol);
+    for(size_t chunkRow = beginChunkRow; chunkRow < endChunkRow; chunkRow++){
+        for(size_t chunkCol = beginChunkCol; chunkCol < endChunkCol; chunkCol++){
+            size_t chunkIdx = chunkRow * cache.chunkCols + chunkCol;
+            const RenderTexture2D& chunk = cache.chunks[chunkIdx];
+            if(cache.dirty[chunkIdx] || chunk.id == 0){
+                // only the tiles of the chunk that are in view
+                size_t tilesBeginRow = std::max(chunkRow * TILESET_CHUNK_SIZE, beginRow);
+                size_t tilesBeginCol = std::max(chunkCol * TILESET_CHUNK_SIZE, beginCol);
+                size_t tilesEndRow = std::min((chunkRow + 1) * TILESET_CHUNK_SIZE, endRow);
+                size_t tilesEndCol = std::min((chunkCol + 1) * TILESET_CHUNK_SIZE, endCol);
+                Vector2 origin = to_Vector2(tileset_get_tile_pos(tileset, tilesBeginRow, tilesBeginCol)) + posVector;
+                draw_tiles(tileset, tilesBeginRow, tilesEndRow, tilesBeginCol, tilesEndCol, origin, &queue);
+                continue;
             }
+            Vector2 chunkPos = to_Vector2(tileset_get_tile_pos(tileset, chunkRow * TILESET_CHUNK_SIZE, chunkCol * TILESET_CHUNK_SIZE)) + posVector;
+            // render textures are stored upside down, hence the negative source height
+            Rectangle sourceRect = {0, 0, (float)chunk.texture.width, -(float)chunk.texture.height};
+            Rectangle destRect = {chunkPos.x, chunkPos.y, (float)chunk.texture.width, (float)chunk.texture.height};
+            queue.push_texture(RenderLayer::TILEMAPS, chunk.texture, sourceRect, destRect);
         }
     }
 }
@@ -0,0 +1,194 @@
+/*
+    FILE: asset_pack.cpp
+    Command line tool that packs asset files into a single archive (see asset_archive.h), which the
+    game then reads through AssetFiles instead of the loose files.
+    Usage: asset_pack [-d|--decode] <output archive> <file or directory>...
+    Paths are stored as given (so pack "resources" from the directory the game runs in). With
+    --decode, images are stored as RGBA pixels and sounds as PCM samples, so they don't need to be
+    decoded when they're loaded.
+*/
+#include<raylib.h>
+#include"asset_archive.h"
+#include"utility/string_hash.h"
+#include<algorithm>
+#include<cstring>
+#include<filesystem>
+#include<fstream>
+#include<iostream>
+#include<iterator>
+#include<string>
+#include<vector>
+
+namespace fs = std::filesystem;
+
+// A file to be packed, with its payload.
+struct PackedFile {
+    std::string path;
+    ArchiveEntryType type = ArchiveEntryType::FILE;
+    uint32_t info[4] = {0, 0, 0, 0};
+    std::vector<unsigned char> payload;
+};
+
+static bool has_extension(const std::string& path, std::initializer_list<const char*> extensions){
+    for(const char* extension : extensions){
+        if(IsFileExtension(path.c_str(), extension)){
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool read_file(const std::string& path, std::vector<unsigned char>& out){
+    std::ifstream file(path, std::ios::binary);
+    if(!file){
+        return false;
+    }
+    out.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    return true;
+}
+
+// Replaces the file's payload with its decoded contents, if it's an image or a sound raylib can decode.
+static void decode_file(PackedFile& file){
+    if(has_extension(file.path, {".png", ".bmp", ".tga", ".jpg", ".gif", ".qoi"})){
+        Image image = LoadImage(file.path.c_str());
+        if(!IsImageValid(image)){
+            return;
+        }
+        ImageFormat(&image, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+        const unsigned char* pixels = (const unsigned char*)image.data;
+        file.payload.assign(pixels, pixels + (size_t)image.width * image.height * 4);
+        file.type = ArchiveEntryType::IMAGE_RGBA8;
+        file.info[0] = image.width;
+        file.info[1] = image.height;
+        UnloadImage(image);
+    } else if(has_extension(file.path, {".wav", ".ogg", ".mp3", ".flac", ".qoa"})){
+        Wave wave = LoadWave(file.path.c_str());
+        if(!IsWaveValid(wave)){
+            return;
+        }
+        const unsigned char* samples = (const unsigned char*)wave.data;
+        file.payload.assign(samples, samples + (size_t)wave.frameCount * wave.channels * (wave.sampleSize / 8));
+        file.type = ArchiveEntryType::WAVE_PCM;
+        file.info[0] = wave.frameCount;
+        file.info[1] = wave.sampleRate;
+        file.info[2] = wave.sampleSize;
+        file.info[3] = wave.channels;
+        UnloadWave(wave);
+    }
+}
+
+static size_t align_up(size_t offset, size_t alignment){
+    return (offset + alignment - 1) / alignment * alignment;
+}
+
+static bool write_archive(const char* outputPath, std::vector<PackedFile>& files){
+    std::vector<ArchiveEntry> entries(files.size());
+    for(size_t i = 0; i < files.size(); i++){
+        entries[i].pathHash = util::hash_string(files[i].path);
+    }
+    // entries are sorted by hash, so that AssetArchive::find can binary search them
+    std::vector<size_t> order(files.size());
+    for(size_t i = 0; i < order.size(); i++){
+        order[i] = i;
+    }
+    std::sort(order.begin(), order.end(), [&](size_t a, size_t b){
+        return (entries[a].pathHash != entries[b].pathHash) ? entries[a].pathHash < entries[b].pathHash : files[a].path < files[b].path;
+    });
+
+    ArchiveHeader header = {};
+    std::memcpy(header.magic, ARCHIVE_MAGIC, sizeof(header.magic));
+    header.version = ARCHIVE_VERSION;
+    header.entryCount = files.size();
+    header.entriesOffset = align_up(sizeof(ArchiveHeader), alignof(ArchiveEntry));
+    header.pathsOffset = header.entriesOffset + files.size() * sizeof(ArchiveEntry);
+    std::string paths;
+    std::vector<ArchiveEntry> sortedEntries;
+    for(size_t index : order){
+        ArchiveEntry entry = entries[index];
+        entry.pathOffset = paths.size();
+        entry.pathSize = files[index].path.size();
+        entry.type = files[index].type;
+        std::memcpy(entry.info, files[index].info, sizeof(entry.info));
+        entry.dataSize = files[index].payload.size();
+        paths += files[index].path;
+        sortedEntries.push_back(entry);
+    }
+    size_t offset = header.pathsOffset + paths.size();
+    for(size_t i = 0; i < sortedEntries.size(); i++){
+        offset = align_up(offset, ARCHIVE_ALIGNMENT);
+        sortedEntries[i].dataOffset = offset;
+        offset += sortedEntries[i].dataSize;
+    }
+
+    std::ofstream out(outputPath, std::ios::binary);
+    if(!out){
+        return false;
+    }
+    auto pad_to = [&out](size_t position){
+        static const char ZEROS[ARCHIVE_ALIGNMENT] = {};
+        size_t current = out.tellp();
+        out.write(ZEROS, position - current);
+    };
+    out.write((const char*)&header, sizeof(header));
+    pad_to(header.entriesOffset);
+    out.write((const char*)sortedEntries.data(), sortedEntries.size() * sizeof(ArchiveEntry));
+    out.write(paths.data(), paths.size());
+    for(size_t i = 0; i < sortedEntries.size(); i++){
+        pad_to(sortedEntries[i].dataOffset);
+        const std::vector<unsigned char>& payload = files[order[i]].payload;
+        out.write((const char*)payload.data(), payload.size());
+    }
+    return (bool)out;
+}
+
+int main(int argc, char** argv){
+    bool decode = false;
+    const char* outputPath = nullptr;
+    std::vector<std::string> inputs;
+    for(int argIdx = 1; argIdx < argc; argIdx++){
+        std::string arg = argv[argIdx];
+        if(arg == "-d" || arg == "--decode"){
+            decode = true;
+        } else if(outputPath == nullptr){
+            outputPath = argv[argIdx];
+        } else {
+            inputs.push_back(arg);
+        }
+    }
+    if(outputPath == nullptr || inputs.empty()){
+        std::cerr << "Usage: " << argv[0] << " [-d|--decode] <output archive> <file or directory>...\n";
+        return 1;
+    }
+    SetTraceLogLevel(LOG_WARNING);
+
+    std::vector<PackedFile> files;
+    for(const std::string& input : inputs){
+        std::vector<std::string> paths;
+        if(fs::is_directory(input)){
+            for(const fs::directory_entry& entry : fs::recursive_directory_iterator(input)){
+                if(entry.is_regular_file()){
+                    paths.push_back(entry.path().generic_string());
+                }
+            }
+        } else {
+            paths.push_back(fs::path(input).generic_string());
+        }
+        for(std::string& path : paths){
+            PackedFile& file = files.emplace_back();
+            file.path = std::move(path);
+            if(!read_file(file.path, file.payload)){
+                std::cerr << "Couldn't read '" << file.path << "'\n";
+                return 1;
+            }
+            if(decode){
+                decode_file(file);
+            }
+        }
+    }
+    if(!write_archive(outputPath, files)){
+        std::cerr << "Couldn't write '" << outputPath << "'\n";
+        return 1;
+    }
+    std::cout << "Packed " << files.size() << " files into " << outputPath << '\n';
+    return 0;
+}
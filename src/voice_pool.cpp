@@ -0,0 +1,183 @@
+#include"voice_pool.h"
+#include"sound_loader.h"
+#include"utility/vector2_util.h"
+#include<chrono>
+#include<mutex>
+#include<optional>
+
+namespace VoicePool {
+
+using Clock = std::chrono::steady_clock;
+
+// (private) A voice, playing an alias of one of the SoundLoader's sounds. The alias is kept after the
+// sound ends, so that playing the same sound on the same voice again doesn't need a new one.
+struct Voice {
+    SoundId source;
+    Sound alias = {};
+    bool hasAlias = false;
+    int priority = 0;
+    float volume = 0.f;
+    Clock::time_point startTime;
+};
+
+static Voice voices[MAX_VOICES];
+static Vector2 listenerPosition = {0, 0};
+static float listenerAudibleDistance = DEFAULT_AUDIBLE_DISTANCE;
+static VoiceStats stats;
+static std::mutex mutex;
+
+static inline bool is_playing(const Voice& voice){
+    return voice.hasAlias && IsSoundPlaying(voice.alias);
+}
+
+static void unload_alias(Voice& voice){
+    if(voice.hasAlias){
+        StopSound(voice.alias);
+        UnloadSoundAlias(voice.alias);
+        voice.hasAlias = false;
+        stats.aliasesLoaded--;
+    }
+}
+
+// Returns true if voice `a` is less important than voice `b`, i.e. should be stolen first.
+static bool is_less_important(const Voice& a, const Voice& b){
+    if(a.priority != b.priority){
+        return a.priority < b.priority;
+    }
+    if(a.volume != b.volume){
+        return a.volume < b.volume;
+    }
+    return a.startTime < b.startTime;
+}
+
+// Picks the voice to play the given sound on, or returns null if it shouldn't be played. Sets `isStolen`
+// if the voice is busy.
+static Voice* pick_voice(SoundId sound, const PlayParams& params, float volume, Clock::time_point now, bool& isStolen){
+    Voice* latestSame = nullptr;
+    Voice* oldestSame = nullptr;
+    size_t numberSame = 0;
+    Voice* freeSame = nullptr; // free, but already has an alias of the sound
+    Voice* freeVoice = nullptr;
+    Voice* leastImportant = nullptr;
+    for(Voice& voice : voices){
+        if(!is_playing(voice)){
+            if(voice.hasAlias && voice.source == sound){
+                freeSame = &voice;
+            } else if(freeVoice == nullptr || !voice.hasAlias){
+                freeVoice = &voice;
+            }
+            continue;
+        }
+        if(voice.source == sound){
+            numberSame++;
+            if(latestSame == nullptr || voice.startTime > latestSame->startTime){
+                latestSame = &voice;
+            }
+            if(oldestSame == nullptr || voice.startTime < oldestSame->startTime){
+                oldestSame = &voice;
+            }
+        }
+        if(leastImportant == nullptr || is_less_important(voice, *leastImportant)){
+            leastImportant = &voice;
+        }
+    }
+
+    if(latestSame != nullptr && std::chrono::duration<float>(now - latestSame->startTime).count() < MIN_RESTART_INTERVAL){
+        if(volume > latestSame->volume){
+            latestSame->volume = volume;
+            SetSoundVolume(latestSame->alias, volume);
+        }
+        stats.merged++;
+        return nullptr;
+    }
+    isStolen = false;
+    if(numberSame >= MAX_VOICES_PER_SOUND){
+        isStolen = true;
+        return oldestSame;
+    }
+    if(freeSame != nullptr){
+        return freeSame;
+    }
+    if(freeVoice != nullptr){
+        return freeVoice;
+    }
+    if(leastImportant->priority > params.priority){
+        stats.dropped++;
+        return nullptr;
+    }
+    isStolen = true;
+    return leastImportant;
+}
+
+void set_listener(Vector2 position, float audibleDistance){
+    std::lock_guard<std::mutex> lock(mutex);
+    listenerPosition = position;
+    listenerAudibleDistance = audibleDistance;
+}
+
+bool play(SoundId sound, const PlayParams& params){
+    std::lock_guard<std::mutex> lock(mutex);
+    float volume = params.volume;
+    if(params.isPositional){
+        float distance = length(params.position - listenerPosition);
+        if(distance >= listenerAudibleDistance){
+            stats.culled++;
+            return false;
+        }
+        volume *= 1.f - distance / listenerAudibleDistance;
+    }
+
+    Clock::time_point now = Clock::now();
+    bool isStolen = false;
+    Voice* voice = pick_voice(sound, params, volume, now, isStolen);
+    if(voice == nullptr){
+        return false;
+    }
+    if(!voice->hasAlias || voice->source != sound){
+        std::optional<Sound> source = SoundLoader::get_sound(sound);
+        if(!source || source->stream.buffer == nullptr){
+            return false;
+        }
+        unload_alias(*voice);
+        voice->alias = LoadSoundAlias(*source);
+        voice->hasAlias = true;
+        voice->source = sound;
+        stats.aliasesLoaded++;
+    }
+    voice->priority = params.priority;
+    voice->volume = volume;
+    voice->startTime = now;
+    SetSoundVolume(voice->alias, volume);
+    PlaySound(voice->alias);
+    stats.played++;
+    stats.stolen += isStolen;
+    return true;
+}
+
+void stop_sound(SoundId sound){
+    std::lock_guard<std::mutex> lock(mutex);
+    for(Voice& voice : voices){
+        if(voice.hasAlias && voice.source == sound){
+            unload_alias(voice);
+        }
+    }
+}
+
+void clear(){
+    std::lock_guard<std::mutex> lock(mutex);
+    for(Voice& voice : voices){
+        unload_alias(voice);
+    }
+}
+
+VoiceStats get_stats(){
+    std::lock_guard<std::mutex> lock(mutex);
+    VoiceStats current = stats;
+    current.activeVoices = 0;
+    for(const Voice& voice : voices){
+        current.activeVoices += is_playing(voice);
+    }
+    return current;
+}
+
+} // namespace VoicePool